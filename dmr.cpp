@@ -411,7 +411,7 @@ void DSDDMR::processSyncOrSkip()
     if (m_symbolIndex > sync_db_size) // accumulate enough symbols to look for a sync
     {
         DSDSync syncEngine;
-        syncEngine.matchSome(m_dsdDecoder->m_dsdSymbol.getSyncDibitBack(sync_db_size), sync_db_size, patterns, 2);
+        syncEngine.matchSome(m_dsdDecoder->m_dsdSymbol.getSyncHistory(), sync_db_size, patterns, 2);
 
         if (syncEngine.isMatching(DSDSync::SyncDMRDataBS))
         {
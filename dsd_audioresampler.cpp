@@ -0,0 +1,230 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#include "dsd_audioresampler.h"
+#include "dsd_simd.h"
+
+namespace DSDcc
+{
+
+const int DSDAudioResampler::m_inRate;
+const int DSDAudioResampler::m_maxInterp;
+
+static int gcd(int a, int b)
+{
+    while (b != 0)
+    {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+static void saturateScalar(const float *in, short *out, int nbSamples)
+{
+    for (int k = 0; k < nbSamples; k++)
+    {
+        float v = in[k] < 32767.0f ? in[k] : 32767.0f;
+        v = v > -32768.0f ? v : -32768.0f;
+        out[k] = (short) lrintf(v);
+    }
+}
+
+#ifdef DSD_SIMD_X86
+
+DSD_SIMD_TARGET("sse2")
+static void saturateSSE2(const float *in, short *out, int nbSamples)
+{
+    int k = 0;
+
+    for (; k + 8 <= nbSamples; k += 8)
+    {
+        __m128i lo = _mm_cvtps_epi32(_mm_loadu_ps(in + k));
+        __m128i hi = _mm_cvtps_epi32(_mm_loadu_ps(in + k + 4));
+        _mm_storeu_si128((__m128i *) (out + k), _mm_packs_epi32(lo, hi)); // saturated to 16 bits
+    }
+
+    saturateScalar(in + k, out + k, nbSamples - k);
+}
+
+#endif // DSD_SIMD_X86
+
+DSDAudioResampler::SaturateKernel DSDAudioResampler::selectSaturateKernel()
+{
+#ifdef DSD_SIMD_X86
+    if (DSDSimd::hasSSE2()) {
+        return saturateSSE2;
+    }
+#endif
+    return saturateScalar;
+}
+
+DSDAudioResampler::DSDAudioResampler() :
+        m_outRate(m_inRate),
+        m_useHP(false),
+        m_gain(1.0f),
+        m_interp(1),
+        m_decim(1),
+        m_tapsPerPhase(0),
+        m_paddedTaps(0),
+        m_coeffs(0),
+        m_history(0),
+        m_index(0),
+        m_phase(0),
+        m_work(0),
+        m_workSize(0)
+{
+    m_dot = DSDFIRFilter::selectKernel();
+    m_saturate = selectSaturateKernel();
+}
+
+DSDAudioResampler::~DSDAudioResampler()
+{
+    delete[] m_work;
+    delete[] m_history;
+    delete[] m_coeffs;
+}
+
+bool DSDAudioResampler::isSupported(int outRate)
+{
+    return (outRate > 0) && (outRate / gcd(m_inRate, outRate) <= m_maxInterp);
+}
+
+void DSDAudioResampler::setOutRate(int outRate, bool useHP, int tapsPerPhase)
+{
+    assert(isSupported(outRate) && (tapsPerPhase > 0));
+
+    int d = gcd(m_inRate, outRate);
+    m_outRate = outRate;
+    m_useHP = useHP;
+    m_interp = outRate / d;
+    m_decim = m_inRate / d;
+
+    delete[] m_work;
+    delete[] m_history;
+    delete[] m_coeffs;
+
+    m_tapsPerPhase = tapsPerPhase;
+    m_paddedTaps = (tapsPerPhase + 7) & ~7;
+    m_coeffs = new float[m_interp * m_paddedTaps];
+    m_history = new float[2*m_tapsPerPhase + 8];
+    m_workSize = 160;
+    m_work = new float[getMaxOutputs(m_workSize)];
+
+    design();
+    reset();
+}
+
+void DSDAudioResampler::setGain(float gain)
+{
+    if (gain == m_gain) {
+        return;
+    }
+
+    m_gain = gain;
+
+    if (m_coeffs) {
+        design();
+    }
+}
+
+/**
+ * Prototype at the interpolated rate with m_interp gain to make up for the inserted zeros. The band
+ * edges are at -6 dB and the transition bands are about 6 times the input rate over the taps per phase
+ * (1000 Hz wide with 48 taps).
+ */
+void DSDAudioResampler::design()
+{
+    memset(m_coeffs, 0, m_interp * m_paddedTaps * sizeof(float));
+
+    int nbTaps = m_interp * m_tapsPerPhase;
+    double fh = 3400.0 / ((double) m_inRate * m_interp); // relative to the interpolated rate
+    double fl = m_useHP ? 300.0 / ((double) m_inRate * m_interp) : 0.0;
+    double center = (nbTaps - 1) / 2.0;
+
+    for (int n = 0; n < nbTaps; n++)
+    {
+        double x = n - center;
+        double sinc = x == 0.0 ?
+                2.0 * (fh - fl) :
+                (sin(2.0 * M_PI * fh * x) - sin(2.0 * M_PI * fl * x)) / (M_PI * x);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * n / (nbTaps - 1)) + 0.08 * cos(4.0 * M_PI * n / (nbTaps - 1));
+        // tap n applies to input x[k-j] at phase p with n = p + j*m_interp. Store oldest sample first
+        int p = n % m_interp;
+        int j = n / m_interp;
+        m_coeffs[p*m_paddedTaps + (m_tapsPerPhase - 1 - j)] = (float) (m_gain * m_interp * sinc * window);
+    }
+}
+
+void DSDAudioResampler::reset()
+{
+    if (m_history) {
+        memset(m_history, 0, (2*m_tapsPerPhase + 8) * sizeof(float));
+    }
+
+    m_index = 0;
+    m_phase = 0;
+}
+
+int DSDAudioResampler::run(const float *in, int nbSamples, float *out)
+{
+    int nbOut = 0;
+
+    for (int i = 0; i < nbSamples; i++)
+    {
+        push(in[i]);
+
+        while (m_phase < m_interp)
+        {
+            out[nbOut++] = m_dot(&m_coeffs[m_phase*m_paddedTaps], &m_history[m_index], m_paddedTaps);
+            m_phase += m_decim;
+        }
+
+        m_phase -= m_interp;
+    }
+
+    return nbOut;
+}
+
+int DSDAudioResampler::run(const float *in, int nbSamples, short *out)
+{
+    int nbOut = 0;
+
+    while (nbSamples > 0)
+    {
+        int n = nbSamples < m_workSize ? nbSamples : m_workSize;
+        int nbWork = run(in, n, m_work);
+        m_saturate(m_work, &out[nbOut], nbWork);
+        nbOut += nbWork;
+        in += n;
+        nbSamples -= n;
+    }
+
+    return nbOut;
+}
+
+} // namespace DSDcc
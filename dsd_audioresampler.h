@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_AUDIORESAMPLER_H_
+#define DSDCC_DSD_AUDIORESAMPLER_H_
+
+#include "dsd_fir.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Rational polyphase resampler of the 8 kS/s vocoder output to any audio rate (16000, 22050, 44100, 48000...).
+ * The prototype filter is a Blackman windowed band pass made of the difference of two sincs: low pass
+ * at 3400 Hz that also rejects the images and optionally high pass at 300 Hz in place of the IIR filters
+ * of DSDMBEAudioInterpolatorFilter. The gain (volume) is folded into the coefficients as well.
+ * Each output sample is a dot product of one phase with the input history using the FIR SIMD kernels.
+ * The int16 output saturates with the SIMD pack instructions instead of clipping each sample.
+ */
+class DSDCC_API DSDAudioResampler
+{
+public:
+    DSDAudioResampler();
+    ~DSDAudioResampler();
+
+    void setOutRate(int outRate, bool useHP, int tapsPerPhase = 48); //!< the rate must be supported (see isSupported)
+    void setGain(float gain);
+    void reset();
+
+    int getOutRate() const { return m_outRate; }
+    int getMaxOutputs(int nbSamples) const { return (nbSamples * m_interp + m_decim - 1) / m_decim; } //!< maximum number of output samples for nbSamples input samples
+
+    int run(const float *in, int nbSamples, float *out); //!< returns the number of samples written to out
+    int run(const float *in, int nbSamples, short *out); //!< same with saturation to 16 bits
+
+    typedef void (*SaturateKernel)(const float *in, short *out, int nbSamples);
+    static SaturateKernel selectSaturateKernel(); //!< rounding float to int16 conversion with saturation for this CPU
+    static bool isSupported(int outRate); //!< false if the interpolation factor exceeds m_maxInterp
+
+    static const int m_inRate = 8000;
+    static const int m_maxInterp = 1024; //!< keeps the coefficients table reasonable
+
+private:
+    void design();
+
+    void push(float sample)
+    {
+        m_history[m_index] = sample;
+        m_history[m_index + m_tapsPerPhase] = sample;
+        m_index = (m_index + 1 == m_tapsPerPhase) ? 0 : m_index + 1;
+    }
+
+    int m_outRate;
+    bool m_useHP;
+    float m_gain;
+    int m_interp;       //!< interpolation factor i.e. number of phases
+    int m_decim;        //!< decimation factor
+    int m_tapsPerPhase;
+    int m_paddedTaps;   //!< taps per phase rounded up to the SIMD width (extra coefficients are zero)
+    float *m_coeffs;    //!< m_interp phases of m_paddedTaps coefficients oldest sample first
+    float *m_history;   //!< 2 * m_tapsPerPhase samples plus padding
+    int m_index;        //!< next write index. Window is m_history[m_index .. m_index + m_tapsPerPhase - 1]
+    int m_phase;        //!< phase of the next output sample relative to the last input sample
+    float *m_work;      //!< float output of the int16 run for up to m_workSize input samples
+    int m_workSize;
+    DSDFIRFilter::DotKernel m_dot;
+    SaturateKernel m_saturate;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_AUDIORESAMPLER_H_ */
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_AUDIOSINK_H_
+#define DSDCC_DSD_AUDIOSINK_H_
+
+#include <stdint.h>
+
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Receives the synthesized speech of a DSDDecoder one AMBE/IMBE frame at a time (see DSDDecoder::setAudioSink).
+ * It is called from the thread running the decoder or from the vocoder thread when that is on.
+ */
+class DSDCC_API DSDAudioSink
+{
+public:
+    virtual ~DSDAudioSink() {}
+
+    /**
+     * One 20 ms frame: 160 samples times the upsampling factor or 20 ms at the audio rate when it is set.
+     * In stereo samples holds L+R pairs and nbSamples counts the pairs.
+     * slot is 0 for TDMA unique or first slot and 1 for second slot.
+     * timestamp is the number of decoder input samples consumed when the frame was extracted.
+     */
+    virtual void audioFrame(int slot, const short *samples, int nbSamples, uint64_t timestamp) = 0;
+
+    /**
+     * Sinks returning true get the frames as float samples in audioFrameFloat instead when the audio rate
+     * is set (see DSDDecoder::setAudioRate). Samples are not clipped to the 16 bit range.
+     */
+    virtual bool floatFrames() const { return false; }
+    virtual void audioFrameFloat(int, const float *, int, uint64_t) {}
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_AUDIOSINK_H_ */
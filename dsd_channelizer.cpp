@@ -0,0 +1,267 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <assert.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#include "dsd_channelizer.h"
+
+namespace DSDcc
+{
+
+static const int channelizerTapsPerPhase = 16;
+static const unsigned int channelizerBlockSize = 512;
+
+struct DSDChannelizer::Channel
+{
+    bool enabled;
+    DSDDecoder *decoder;        //!< taken from the pool and configured on first use
+    std::complex<float> *block; //!< samples being gathered for the next block
+    unsigned int fill;
+    float power;                //!< sum of the squared magnitudes over the block
+    int quietBlocks;            //!< consecutive blocks under the gate threshold
+};
+
+/**
+ * The prototype low pass filter is a Blackman windowed sinc cut at 0.6 times the channel spacing
+ * (1.2 times half the spacing, which the 2x oversampled channels allow) relative to the wideband rate,
+ * with 16 taps per phase. Unity gain at DC.
+ */
+DSDChannelizer::DSDChannelizer(int sampleRate, int nbChannels, int nbThreads) :
+        m_sampleRate(sampleRate),
+        m_nbChannels(nbChannels),
+        m_decimation(nbChannels / 2),
+        m_channelRate(2 * sampleRate / nbChannels),
+        m_nbTaps(nbChannels * channelizerTapsPerPhase),
+        m_index(0),
+        m_phase(nbChannels / 2),
+        m_time(0),
+        m_fft(nbChannels),
+        m_blockSize(channelizerBlockSize),
+        m_pool(nbChannels, nbThreads),
+        m_gating(false),
+        m_gateThreshold(1e-6f),
+        m_gateHang(25)
+{
+    assert((nbChannels >= 2) && ((nbChannels & (nbChannels - 1)) == 0));
+    assert(DSDDecoder::isInputRateSupported(m_channelRate));
+
+    m_coeffs = new float[m_nbTaps];
+    m_history = new std::complex<float>[2*m_nbTaps]; // zero initialized
+    m_fftBuffer = new std::complex<float>[m_nbChannels];
+    m_rotation = new std::complex<float>[m_nbChannels];
+
+    double fc = 0.6 / m_nbChannels;
+    double center = (m_nbTaps - 1) / 2.0;
+    double sum = 0.0;
+
+    for (int n = 0; n < m_nbTaps; n++)
+    {
+        double x = n - center;
+        double sinc = x == 0.0 ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * n / (m_nbTaps - 1)) + 0.08 * cos(4.0 * M_PI * n / (m_nbTaps - 1));
+        m_coeffs[m_nbTaps - 1 - n] = (float) (sinc * window);
+        sum += sinc * window;
+    }
+
+    for (int n = 0; n < m_nbTaps; n++) {
+        m_coeffs[n] /= sum;
+    }
+
+    for (int i = 0; i < m_nbChannels; i++) {
+        m_rotation[i] = std::complex<float>((float) cos(2.0 * M_PI * i / m_nbChannels), (float) -sin(2.0 * M_PI * i / m_nbChannels));
+    }
+
+    m_channels = new Channel[m_nbChannels];
+
+    for (int i = 0; i < m_nbChannels; i++)
+    {
+        m_channels[i].enabled = false;
+        m_channels[i].decoder = 0;
+        m_channels[i].block = 0;
+        m_channels[i].fill = 0;
+        m_channels[i].power = 0.0f;
+        m_channels[i].quietBlocks = 0;
+    }
+}
+
+DSDChannelizer::~DSDChannelizer()
+{
+    for (int i = 0; i < m_nbChannels; i++) {
+        delete[] m_channels[i].block;
+    }
+
+    delete[] m_channels;
+    delete[] m_rotation;
+    delete[] m_fftBuffer;
+    delete[] m_history;
+    delete[] m_coeffs;
+}
+
+void DSDChannelizer::setChannelEnabled(int channel, bool enabled)
+{
+    assert((channel >= 0) && (channel < m_nbChannels));
+    Channel& ch = m_channels[channel];
+
+    if (enabled && !ch.block)
+    {
+        ch.block = new std::complex<float>[m_blockSize];
+        getDecoder(channel);
+    }
+
+    ch.enabled = enabled;
+    ch.fill = 0;
+    ch.power = 0.0f;
+    ch.quietBlocks = 0;
+}
+
+DSDDecoder *DSDChannelizer::getDecoder(int channel)
+{
+    assert((channel >= 0) && (channel < m_nbChannels));
+    Channel& ch = m_channels[channel];
+
+    if (!ch.decoder)
+    {
+        ch.decoder = m_pool.getDecoder(channel);
+        bool rateSet = ch.decoder->setInputRate(m_channelRate);
+        assert(rateSet);
+        (void) rateSet;
+        ch.decoder->setDecodeMode(DSDDecoder::DSDDecodeAuto, true);
+    }
+
+    return ch.decoder;
+}
+
+void DSDChannelizer::setAudioCallback(AudioCallback callback, void *context)
+{
+    m_pool.setAudioCallback(callback, context);
+}
+
+void DSDChannelizer::setDVFrameCallback(DVFrameCallback callback, void *context)
+{
+    m_pool.setDVFrameCallback(callback, context);
+}
+
+void DSDChannelizer::setActivityGate(bool gating, float thresholdDb, int hangBlocks)
+{
+    m_gating = gating;
+    m_gateThreshold = powf(10.0f, thresholdDb / 10.0f);
+    m_gateHang = hangBlocks;
+}
+
+float DSDChannelizer::getChannelFrequency(int channel) const
+{
+    int k = channel < m_nbChannels / 2 ? channel : channel - m_nbChannels;
+    return (float) k * m_sampleRate / m_nbChannels;
+}
+
+bool DSDChannelizer::isChannelActive(int channel) const
+{
+    const Channel& ch = m_channels[channel];
+    return ch.enabled && (!m_gating || (ch.quietBlocks <= m_gateHang));
+}
+
+void DSDChannelizer::run(const std::complex<float> *samples, unsigned int nbSamples)
+{
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        m_history[m_index] = samples[i];
+        m_history[m_index + m_nbTaps] = samples[i];
+        m_index = (m_index + 1 == m_nbTaps) ? 0 : m_index + 1;
+        m_time = (m_time + 1) & (m_nbChannels - 1);
+
+        if (--m_phase == 0)
+        {
+            channelize();
+            m_phase = m_decimation;
+        }
+    }
+}
+
+/**
+ * Channel k output at time t (t input samples received so far) is the input mixed down by k times the
+ * spacing and low pass filtered. With the time reversed window w and coefficients c (oldest first) this is
+ * y[k] = exp(-j.2.pi.k.t/N) . sum over n of v[n] exp(-j.2.pi.k.n/N) with v[n] = sum over q of c[qN+n] w[qN+n]
+ * i.e. a forward FFT of the folded window followed by a rotation.
+ */
+void DSDChannelizer::channelize()
+{
+    const std::complex<float> *w = &m_history[m_index];
+    const int n = m_nbChannels;
+
+    for (int i = 0; i < n; i++) {
+        m_fftBuffer[i] = m_coeffs[i] * w[i];
+    }
+
+    for (int q = 1; q < channelizerTapsPerPhase; q++)
+    {
+        const float *c = &m_coeffs[q*n];
+        const std::complex<float> *x = &w[q*n];
+
+        for (int i = 0; i < n; i++) {
+            m_fftBuffer[i] += c[i] * x[i];
+        }
+    }
+
+    m_fft.transform(m_fftBuffer, false);
+
+    for (int k = 0; k < n; k++)
+    {
+        Channel& ch = m_channels[k];
+
+        if (!ch.enabled) {
+            continue;
+        }
+
+        std::complex<float> y = m_fftBuffer[k] * m_rotation[(k * m_time) & (n - 1)];
+        ch.block[ch.fill++] = y;
+        ch.power += y.real()*y.real() + y.imag()*y.imag();
+
+        if (ch.fill == m_blockSize) {
+            submit(k);
+        }
+    }
+}
+
+void DSDChannelizer::submit(int channel)
+{
+    Channel& ch = m_channels[channel];
+
+    if (m_gating && (ch.power / ch.fill < m_gateThreshold)) {
+        ch.quietBlocks++;
+    } else {
+        ch.quietBlocks = 0;
+    }
+
+    if (!m_gating || (ch.quietBlocks <= m_gateHang)) {
+        m_pool.submitIQ(channel, ch.block, ch.fill);
+    }
+
+    ch.fill = 0;
+    ch.power = 0.0f;
+}
+
+void DSDChannelizer::flush()
+{
+    m_pool.flush();
+}
+
+} // namespace DSDcc
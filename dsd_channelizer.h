@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_CHANNELIZER_H_
+#define DSDCC_DSD_CHANNELIZER_H_
+
+#include <complex>
+
+#include "dsd_decoder.h"
+#include "dsd_fft.h"
+#include "dsd_pool.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Splits a wideband complex stream into nbChannels channels spaced by sampleRate / nbChannels with a
+ * 2 times oversampled polyphase filter bank followed by an FFT. Channel k is centered at
+ * k times the spacing for k below nbChannels / 2 and at (k - nbChannels) times the spacing above.
+ *
+ * Each enabled channel feeds its own DSDDecoder with complex samples at twice the spacing (runIQ).
+ * Decoders start in DSDDecodeAuto mode. Set DSDDecodeAutoRate through getDecoder to identify channels
+ * whatever their symbol rate at the cost of two more symbol chains while they search for sync.
+ * Channel samples are gathered in blocks that are decoded by a DSDDecoderPool. Audio and DV frames
+ * are delivered through the pool callbacks invoked from the worker threads.
+ *
+ * With the activity gate on, blocks of channels whose power stayed under the threshold for more
+ * than the hang time are dropped before reaching the workers.
+ */
+class DSDCC_API DSDChannelizer
+{
+public:
+    typedef DSDDecoderPool::AudioCallback AudioCallback;
+    typedef DSDDecoderPool::DVFrameCallback DVFrameCallback;
+
+    DSDChannelizer(int sampleRate, int nbChannels, int nbThreads); //!< nbChannels must be a power of 2 and the channel rate 2*sampleRate/nbChannels supported by DSDDecoder::isInputRateSupported. nbThreads 0 for one per hardware thread
+    ~DSDChannelizer();
+
+    void setChannelEnabled(int channel, bool enabled);
+    DSDDecoder *getDecoder(int channel); //!< created on first call or first enable. Change settings only when workers are idle (see flush)
+    void setAudioCallback(AudioCallback callback, void *context);   //!< set before running
+    void setDVFrameCallback(DVFrameCallback callback, void *context); //!< set before running
+    void setActivityGate(bool gating, float thresholdDb = -60.0f, int hangBlocks = 25); //!< threshold is the channel block power in dB relative to a unit amplitude
+
+    int getNbChannels() const { return m_nbChannels; }
+    int getChannelRate() const { return m_channelRate; }
+    float getChannelFrequency(int channel) const; //!< channel center frequency relative to the wideband stream center in Hz
+    bool isChannelActive(int channel) const;
+
+    void run(const std::complex<float> *samples, unsigned int nbSamples); //!< wideband input
+    void flush(); //!< returns when all blocks submitted so far have been decoded
+
+private:
+    struct Channel;
+
+    void channelize(); //!< one output sample for each channel from the current input window
+    void submit(int channel);
+
+    int m_sampleRate;
+    int m_nbChannels;
+    int m_decimation;      //!< input samples per channel sample: half the number of channels
+    int m_channelRate;
+    int m_nbTaps;          //!< prototype filter length: m_nbChannels times the number of taps per phase
+    float *m_coeffs;       //!< prototype filter in time reversed order
+    std::complex<float> *m_history; //!< 2 * m_nbTaps input samples so that the window is contiguous
+    int m_index;           //!< next write index in m_history
+    int m_phase;           //!< input samples until next channelization
+    int m_time;            //!< input samples received modulo m_nbChannels
+    std::complex<float> *m_fftBuffer;
+    DSDFFT m_fft;
+    std::complex<float> *m_rotation; //!< exp(-j.2.pi.i/m_nbChannels)
+    unsigned int m_blockSize;  //!< channel samples per block submitted to the pool
+
+    Channel *m_channels;
+    DSDDecoderPool m_pool;
+    bool m_gating;
+    float m_gateThreshold; //!< linear power
+    int m_gateHang;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_CHANNELIZER_H_ */
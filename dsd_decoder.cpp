@@ -21,6 +21,8 @@
 #include "timeutil.h"
 #include "dsd_sync.h"
 #include "dsd_decoder.h"
+#include "dsd_vocoder.h"
+#include "dsd_framerecorder.h"
 
 #pragma warning(disable : 4996)
 
@@ -30,11 +32,21 @@ namespace DSDcc
 DSDDecoder::DSDDecoder() :
         m_fsmState(DSDLookForSync),
         m_dsdSymbol(this),
+        m_autoRate(false),
+        m_rateProbe1(this),
+        m_rateProbe2(this),
+        m_autoRateIdleSamples(DSD_AUTORATE_HOLD_SAMPLES),
+        m_autoRateHoldSamples(DSD_AUTORATE_HOLD_SAMPLES),
         m_mbelibEnable(true),
         m_mbeRate(DSDMBERateNone),
-        m_mbeDecoder1(this),
-        m_mbeDecoder2(this),
+        m_mbeDecoder1(this, 0),
+        m_mbeDecoder2(this, 1),
+        m_vocoder(0),
+        m_audioSink(0),
+        m_sampleCount(0),
+        m_frameRecorder(0),
         m_mbeDVReady1(false),
+        m_mbeDVReady2(false),
         m_dsdDMR(this),
         m_dsdDstar(this),
         m_dsdYSF(this),
@@ -49,11 +61,13 @@ DSDDecoder::DSDDecoder() :
     resetFrameSync();
     noCarrier();
     m_squelchTimeoutCount = 0;
+    m_squelchTimeoutSamples = DSD_SQUELCH_TIMEOUT_SAMPLES;
     m_nxdnInterSyncCount = -1; // reset to quiet state
 }
 
 DSDDecoder::~DSDDecoder()
 {
+    delete m_vocoder;
 }
 
 void DSDDecoder::setQuiet()
@@ -118,6 +132,7 @@ void DSDDecoder::setDecodeMode(DSDDecodeMode mode, bool on)
     case DSDDecodeNone:
         if (on)
         {
+            m_autoRate = false;
             m_opts.frame_dmr = 0;
             m_opts.frame_dstar = 0;
             m_opts.frame_p25p1 = 0;
@@ -175,43 +190,20 @@ void DSDDecoder::setDecodeMode(DSDDecodeMode mode, bool on)
         TRACE("%s the decoding of YSF frames.\n", (on ? "Enabling" : "Disabling"));
         break;
     case DSDDecodeAuto:
-        m_opts.frame_dmr = 0;
-        m_opts.frame_dstar = 0;
-        m_opts.frame_p25p1 = 0;
-        m_opts.frame_nxdn48 = 0;
-        m_opts.frame_nxdn96 = 0;
-        m_opts.frame_provoice = 0;
-        m_opts.frame_x2tdma = 0;
-        m_opts.frame_dpmr = 0;
-        m_opts.frame_ysf = 0;
-        switch (m_dataRate)
-        {
-        case DSDRate2400:
-            m_opts.frame_nxdn48 = (on ? 1 : 0);
-            m_opts.frame_dpmr = (on ? 1 : 0);
-            break;
-        case DSDRate4800:
-            m_opts.frame_dmr = (on ? 1 : 0);
-            m_opts.frame_dstar = (on ? 1 : 0);
-            m_opts.frame_x2tdma = (on ? 1 : 0);
-            m_opts.frame_p25p1 = (on ? 1 : 0);
-            m_opts.frame_nxdn96 = (on ? 1 : 0);
-            m_opts.frame_ysf = (on ? 1 : 0);
-            break;
-        case DSDRate9600:
-            m_opts.frame_provoice = (on ? 1 : 0);
-            break;
-        default:
-            m_opts.frame_dmr = (on ? 1 : 0);
-            m_opts.frame_dstar = (on ? 1 : 0);
-            m_opts.frame_x2tdma = (on ? 1 : 0);
-            m_opts.frame_p25p1 = (on ? 1 : 0);
-            m_opts.frame_nxdn96 = (on ? 1 : 0);
-            m_opts.frame_ysf = (on ? 1 : 0);
-            break;
-        }
+        m_autoRate = false;
+        enableAutoFrames(on);
         TRACE("%s auto frame decoding.\n", (on ? "Enabling" : "Disabling"));
         break;
+    case DSDDecodeAutoRate:
+        m_autoRate = on;
+        enableAutoFrames(on);
+
+        if (on) {
+            configureRateProbes();
+        }
+
+        TRACE("%s auto frame and symbol rate decoding.\n", (on ? "Enabling" : "Disabling"));
+        break;
     default:
         break;
     }
@@ -222,6 +214,45 @@ void DSDDecoder::setDecodeMode(DSDDecodeMode mode, bool on)
     m_nxdnInterSyncCount = -1; // reset to quiet state
 }
 
+void DSDDecoder::enableAutoFrames(bool on)
+{
+    m_opts.frame_dmr = 0;
+    m_opts.frame_dstar = 0;
+    m_opts.frame_p25p1 = 0;
+    m_opts.frame_nxdn48 = 0;
+    m_opts.frame_nxdn96 = 0;
+    m_opts.frame_provoice = 0;
+    m_opts.frame_x2tdma = 0;
+    m_opts.frame_dpmr = 0;
+    m_opts.frame_ysf = 0;
+    switch (m_dataRate)
+    {
+    case DSDRate2400:
+        m_opts.frame_nxdn48 = (on ? 1 : 0);
+        m_opts.frame_dpmr = (on ? 1 : 0);
+        break;
+    case DSDRate4800:
+        m_opts.frame_dmr = (on ? 1 : 0);
+        m_opts.frame_dstar = (on ? 1 : 0);
+        m_opts.frame_x2tdma = (on ? 1 : 0);
+        m_opts.frame_p25p1 = (on ? 1 : 0);
+        m_opts.frame_nxdn96 = (on ? 1 : 0);
+        m_opts.frame_ysf = (on ? 1 : 0);
+        break;
+    case DSDRate9600:
+        m_opts.frame_provoice = (on ? 1 : 0);
+        break;
+    default:
+        m_opts.frame_dmr = (on ? 1 : 0);
+        m_opts.frame_dstar = (on ? 1 : 0);
+        m_opts.frame_x2tdma = (on ? 1 : 0);
+        m_opts.frame_p25p1 = (on ? 1 : 0);
+        m_opts.frame_nxdn96 = (on ? 1 : 0);
+        m_opts.frame_ysf = (on ? 1 : 0);
+        break;
+    }
+}
+
 void DSDDecoder::setAudioGain(float gain)
 {
     m_opts.audio_gain = gain;
@@ -280,12 +311,171 @@ void DSDDecoder::setUpsampling(int upsampling)
     TRACE("Setting upsampling to x%d\n", upsampling);
 }
 
+bool DSDDecoder::setAudioRate(int audioRate)
+{
+    if (!isAudioRateSupported(audioRate))
+    {
+        TRACE("DSDDecoder::setAudioRate: %d S/s is not supported\n", audioRate);
+        return false;
+    }
+
+    m_mbeDecoder1.setAudioRate(audioRate);
+    m_mbeDecoder2.setAudioRate(audioRate);
+    TRACE("Setting audio rate to %d S/s\n", audioRate);
+    return true;
+}
+
 void DSDDecoder::setStereo(bool on)
 {
 	m_mbeDecoder1.setStereo(on);
 	m_mbeDecoder2.setStereo(on);
 }
 
+void DSDDecoder::setVocoderThread(bool on, bool waitWhenFull)
+{
+    if (on && !m_vocoder)
+    {
+        m_mbeDecoder1.resetAudio();
+        m_mbeDecoder2.resetAudio();
+        m_vocoder = new DSDVocoder(&m_mbeDecoder1, &m_mbeDecoder2, waitWhenFull);
+    }
+    else if (!on && m_vocoder)
+    {
+        delete m_vocoder;
+        m_vocoder = 0;
+    }
+}
+
+void DSDDecoder::setAudioSink(DSDAudioSink *audioSink)
+{
+    m_audioSink = audioSink;
+    m_mbeDecoder1.resetAudio();
+    m_mbeDecoder2.resetAudio();
+}
+
+void DSDDecoder::flushVocoder()
+{
+    if (m_vocoder) {
+        m_vocoder->flush();
+    }
+}
+
+unsigned int DSDDecoder::getVocoderDroppedFrames() const
+{
+    return m_vocoder ? m_vocoder->getDroppedFrames() : 0;
+}
+
+void DSDDecoder::setFrameRecorder(DSDFrameRecorder *frameRecorder)
+{
+    m_frameRecorder = frameRecorder;
+
+    if (m_frameRecorder) {
+        m_frameRecorder->writeSession(m_sampleCount, getInputRate());
+    }
+}
+
+void DSDDecoder::synthesizeRecord(DSDFrameRecord& record)
+{
+    DSDMBEDecoder& mbeDecoder = record.m_slot == 0 ? m_mbeDecoder1 : m_mbeDecoder2;
+    mbeDecoder.m_timestamp = record.m_timestamp;
+
+    switch (record.m_type)
+    {
+    case DSDFrameRecord::RecordSession: // recordings may be appended: each session starts from initial MBE parameters
+        m_mbeDecoder1.initSynthesis();
+        m_mbeDecoder2.initSynthesis();
+        break;
+    case DSDFrameRecord::RecordFrame:
+        mbeDecoder.synthesizeFrame(record.m_mbeRate, record.m_uvquality, record.m_imbe_fr, record.m_ambe_fr, record.m_imbe7100_fr);
+        break;
+    case DSDFrameRecord::RecordData:
+        mbeDecoder.synthesizeData(record.m_mbeRate, record.m_uvquality, record.m_imbe_data, record.m_ambe_data);
+        break;
+    case DSDFrameRecord::RecordInit:
+        mbeDecoder.initSynthesis();
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * IDs or callsigns of the current signal. Unlike formatStatusText the text has no state of its own and
+ * only changes with the call so that the recorder writes it once per call.
+ */
+void DSDDecoder::recordCallInfo(int slot)
+{
+    char text[DSDFrameRecord::m_maxTextSize+1];
+
+    switch (getSyncType())
+    {
+    case DSDSyncDMRDataMS:
+    case DSDSyncDMRDataP:
+    case DSDSyncDMRVoiceMS:
+    case DSDSyncDMRVoiceP:
+        snprintf(text, sizeof(text), "DMR>S%d %.25s", slot + 1, (slot == 0 ? getDMRDecoder().getSlot0Text() : getDMRDecoder().getSlot1Text()) + 1);
+        break;
+    case DSDSyncDStarHeaderN:
+    case DSDSyncDStarHeaderP:
+    case DSDSyncDStarN:
+    case DSDSyncDStarP:
+        snprintf(text, sizeof(text), "DST>%s>%s|%s>%s",
+                getDStarDecoder().getMySign().c_str(),
+                getDStarDecoder().getYourSign().c_str(),
+                getDStarDecoder().getRpt1().c_str(),
+                getDStarDecoder().getRpt2().c_str());
+        break;
+    case DSDSyncDPMR:
+        snprintf(text, sizeof(text), "DPM>CC: %04d OI: %08d CI: %08d",
+                getDPMRDecoder().getColorCode(),
+                getDPMRDecoder().getOwnId(),
+                getDPMRDecoder().getCalledId());
+        break;
+    case DSDSyncYSF:
+        if (getYSFDecoder().radioIdMode()) {
+            snprintf(text, sizeof(text), "YSF>%s>%s:%s", getYSFDecoder().getSrc(), getYSFDecoder().getDestId(), getYSFDecoder().getSrcId());
+        } else {
+            snprintf(text, sizeof(text), "YSF>%s>%s", getYSFDecoder().getSrc(), getYSFDecoder().getDest());
+        }
+        break;
+    case DSDSyncNXDNN:
+    case DSDSyncNXDNP:
+        snprintf(text, sizeof(text), "NXD>%02d %05d>%c%05d",
+                getNXDNDecoder().getRAN(),
+                getNXDNDecoder().getSourceId(),
+                getNXDNDecoder().isGroupCall() ? 'G' : 'I',
+                getNXDNDecoder().getDestinationId());
+        break;
+    case DSDSyncP25p1P:
+    case DSDSyncP25p1N:
+        snprintf(text, sizeof(text), "P25>NAC:%03X TG:%05d SRC:%08d",
+                getP25Decoder().getNAC(),
+                getP25Decoder().getTalkGroup(),
+                getP25Decoder().getSource());
+        break;
+    default:
+        text[0] = '\0';
+        break;
+    }
+
+    int length = strlen(text);
+
+    while ((length > 0) && (text[length-1] == ' ')) {
+        length--;
+    }
+
+    text[length] = '\0';
+
+    for (int i = 0; i < length; i++)
+    {
+        if ((text[i] < ' ') || (text[i] > '~')) { // headers received with errors
+            text[i] = '.';
+        }
+    }
+
+    m_frameRecorder->writeCallInfo(slot, m_sampleCount, getSyncType(), text);
+}
+
 void DSDDecoder::setInvertedXTDMA(bool on)
 {
     m_opts.inverted_x2tdma = (on ? 1 : 0);
@@ -333,16 +523,143 @@ void DSDDecoder::setDataRate(DSDRate dataRate)
         m_dsdSymbol.setSamplesPerSymbol(10);
         break;
     }
+
+    configureSymbolChain(getInputRate());
 }
 
-void DSDDecoder::run(short sample)
+bool DSDDecoder::isInputRateSupported(int sampleRate)
+{
+    // the symbol chain may fall back to 48 kS/s with any data rate or timing
+    return (sampleRate >= 6000) && DSDResampler::isSupported(sampleRate, 48000);
+}
+
+bool DSDDecoder::setInputRate(int sampleRate)
+{
+    if (!isInputRateSupported(sampleRate))
+    {
+        TRACE("DSDDecoder::setInputRate: %d S/s is not supported\n", sampleRate);
+        return false;
+    }
+
+    configureSymbolChain(sampleRate);
+    m_discriminator.configure(sampleRate, m_discriminator.getBandwidth(), m_discriminator.getMaxDeviation());
+    TRACE("Set input rate to %d S/s\n", sampleRate);
+    return true;
+}
+
+void DSDDecoder::setIQDemodulation(float bandwidth, float maxDeviation)
+{
+    m_discriminator.configure(getInputRate(), bandwidth, maxDeviation);
+    TRACE("Set IQ channel bandwidth to %.0f Hz and maximum deviation to %.0f Hz\n", bandwidth, maxDeviation);
+}
+
+void DSDDecoder::setTimingRecovery(DSDSymbol::TimingRecovery timingRecovery)
+{
+    m_dsdSymbol.setTimingRecovery(timingRecovery);
+    configureSymbolChain(getInputRate());
+}
+
+void DSDDecoder::configureSymbolChain(int inputRate)
+{
+    // fractional timing recovery does not need the resampling to 48 kS/s and the zero crossing
+    // timing runs natively at 24 and 12 kS/s when this makes an integer number of samples per symbol
+    int chainRate = DSDSymbol::getChainRate(inputRate, m_dsdSymbol.getBaudRate(), m_dsdSymbol.getTimingRecovery());
+
+    m_inputResampler.setRates(inputRate, chainRate);
+    m_dsdSymbol.setSampleRate(chainRate);
+    m_squelchTimeoutSamples = (DSD_SQUELCH_TIMEOUT_SAMPLES * chainRate) / 48000;
+    m_autoRateHoldSamples = (DSD_AUTORATE_HOLD_SAMPLES * chainRate) / 48000;
+
+    if (m_autoRate) {
+        configureRateProbes();
+    }
+}
+
+/**
+ * The probes search the two symbol rates the decoder is not at. They take the decoder symbol chain
+ * samples so that the input resampling is shared.
+ */
+void DSDDecoder::configureRateProbes()
+{
+    static const int baudRates[3] = {2400, 4800, 9600};
+    DSDRateProbe *probes[2] = {&m_rateProbe1, &m_rateProbe2};
+    int iProbe = 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (baudRates[i] != m_dsdSymbol.getBaudRate()) {
+            probes[iProbe++]->configure(baudRates[i], getInputRate(), m_dsdSymbol.getSampleRate(), m_dsdSymbol.getTimingRecovery());
+        }
+    }
+
+    m_autoRateIdleSamples = m_autoRateHoldSamples;
+}
+
+/**
+ * Probes run only while the decoder searches for sync. A sync found by a probe moves the decoder
+ * to that symbol rate unless the decoder had a sync less than m_autoRateHoldSamples ago
+ * so that a noise match does not pull it away from a signal between two of its frames.
+ * The probe history is then replayed through the decoder so that it finds the same sync and
+ * decodes the frame that follows. Returns true when this happened with the frames count of the replay.
+ */
+bool DSDDecoder::runRateProbes(short sample, int& nbFrames)
+{
+    if (m_fsmState != DSDLookForSync)
+    {
+        m_autoRateIdleSamples = -1;
+        return false;
+    }
+
+    if (m_autoRateIdleSamples < 0)
+    {
+        m_rateProbe1.reset();
+        m_rateProbe2.reset();
+        m_autoRateIdleSamples = 0;
+    }
+
+    if (m_autoRateIdleSamples < m_autoRateHoldSamples) {
+        m_autoRateIdleSamples++;
+    }
+
+    DSDRateProbe *probe = 0;
+
+    if (m_rateProbe1.run(sample)) {
+        probe = &m_rateProbe1;
+    }
+
+    if (m_rateProbe2.run(sample) && !probe) {
+        probe = &m_rateProbe2;
+    }
+
+    if (!probe || (m_autoRateIdleSamples < m_autoRateHoldSamples)) {
+        return false;
+    }
+
+    int baudRate = probe->getBaudRate();
+    int nbReplay = probe->copyHistory(m_autoRateReplay);
+    TRACE("DSDDecoder::runRateProbes: sync found at %d baud. Replay %d samples\n", baudRate, nbReplay);
+    setDataRate(baudRate == 2400 ? DSDRate2400 : baudRate == 9600 ? DSDRate9600 : DSDRate4800);
+    setDecodeMode(DSDDecodeAutoRate, true);
+
+    m_autoRate = false; // no probes while replaying
+    nbFrames = 0;
+
+    for (int i = 0; i < nbReplay; i++) {
+        nbFrames += processSample(m_autoRateReplay[i]);
+    }
+
+    m_autoRate = true;
+    return true;
+}
+
+void DSDDecoder::checkSquelch(short sample)
 {
     // mode time out if squelch has been closed for a number of samples
     if (m_fsmState != DSDLookForSync)
     {
         if (sample == 0)
         {
-            if (m_squelchTimeoutCount < DSD_SQUELCH_TIMEOUT_SAMPLES)
+            if (m_squelchTimeoutCount < m_squelchTimeoutSamples)
             {
                 m_squelchTimeoutCount++;
             }
@@ -358,77 +675,198 @@ void DSDDecoder::run(short sample)
             m_squelchTimeoutCount = 0;
         }
     }
+}
+
+void DSDDecoder::run(short sample)
+{
+    m_sampleCount++;
+
+    if (m_inputResampler.isPassThrough())
+    {
+        processSample(sample);
+        return;
+    }
+
+    int nbResampled = m_inputResampler.run(sample, m_resampled);
+
+    for (int i = 0; i < nbResampled; i++) {
+        processSample(m_resampled[i]);
+    }
+}
 
-    if (m_dsdSymbol.pushSample(sample)) // a symbol is retrieved
+int DSDDecoder::run(const short *samples, unsigned int nbSamples)
+{
+    int nbFrames = 0;
+
+    if (m_inputResampler.isPassThrough() && !m_autoRate) // the chain rate may change within the block in auto rate mode
     {
-        switch (m_fsmState)
+        for (unsigned int i = 0; i < nbSamples; i++)
         {
-        case DSDLookForSync:
-            m_sync = getFrameSync(); // -> -2: still looking, -1 not found, 0 and above: sync found
+            m_sampleCount++;
+            nbFrames += processSample(samples[i]);
+        }
 
-            if (m_sync == -2) // -2 means no sync has been found at all
-            {
-                break; // still searching -> no change in FSM state
-            }
-            else if (m_sync == -1) // -1 means sync has been found but is invalid
-            {
-                //TRACE("DSDDecoder::run: invalid sync found: %d symbol %d (%d)\n", m_sync, m_state.symbolcnt, m_dsdSymbol.getSymbol());
-                resetFrameSync(); // go back searching
-            }
-            else // good sync found
-            {
-                //TRACE("DSDDecoder::run: good sync found: %d symbol %d (%d)\r\n", m_sync, m_state.symbolcnt, m_dsdSymbol.getSymbol());
-                m_fsmState = DSDSyncFound; // go to processing state next time
-            }
+        return nbFrames;
+    }
 
-            break; // next
-        case DSDSyncFound:
-            m_syncType  = (DSDSyncType) m_sync;
-            //TRACE("DSDDecoder::run: before processFrameInit: symbol %d (%d)\n", m_state.symbolcnt, m_dsdSymbol.getSymbol());
-            processFrameInit();   // initiate the process of the frame which sync has been found. This will change FSM state
-            break;
-        case DSDprocessDMRvoice:
-            m_dsdDMR.processVoice();
-            break;
-        case DSDprocessDMRvoiceMS:
-            m_dsdDMR.processVoiceMS();
-            break;
-        case DSDprocessDMRdata:
-            m_dsdDMR.processData();
-            break;
-        case DSDprocessDMRdataMS:
-            m_dsdDMR.processDataMS();
-            break;
-        case DSDprocessDMRsyncOrSkip:
-            m_dsdDMR.processSyncOrSkip();
-            break;
-        case DSDprocessDMRSkipMS:
-            m_dsdDMR.processSkipMS();
-            break;
-        case DSDprocessDSTAR:
-            m_dsdDstar.process();
-            break;
-        case DSDprocessDSTAR_HD:
-            m_dsdDstar.processHD();
-            break;
-        case DSDprocessYSF:
-            m_dsdYSF.process();
-            break;
-        case DSDprocessDPMR:
-            m_dsdDPMR.process();
-            break;
-        case DSDprocessNXDN:
-            m_dsdNXDN.process();
-            break;
-        case DSDprocessP25p1:
-            m_dsdP25P1.process();
-            break;
-        case DSDprocessP25p1HD:
-            m_dsdP25P1.processHDU();
-            break;
-        default:
-            break;
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        m_sampleCount++;
+
+        if (m_inputResampler.isPassThrough())
+        {
+            nbFrames += processSample(samples[i]);
+            continue;
+        }
+
+        int nbResampled = m_inputResampler.run(samples[i], m_resampled);
+
+        for (int j = 0; j < nbResampled; j++) {
+            nbFrames += processSample(m_resampled[j]);
+        }
+    }
+
+    return nbFrames;
+}
+
+int DSDDecoder::runIQ(const std::complex<float> *samples, unsigned int nbSamples)
+{
+    int nbFrames = 0;
+    const unsigned int blockSize = sizeof(m_discriminated) / sizeof(short);
+
+    while (nbSamples > 0)
+    {
+        unsigned int n = nbSamples < blockSize ? nbSamples : blockSize;
+        m_discriminator.run(samples, m_discriminated, n);
+        nbFrames += run(m_discriminated, n);
+        samples += n;
+        nbSamples -= n;
+    }
+
+    return nbFrames;
+}
+
+/** Process one sample at the symbol chain rate. Returns the number of AMBE/IMBE frames that became ready */
+int DSDDecoder::processSample(short sample)
+{
+    checkSquelch(sample);
+    int nbFrames;
+
+    if (m_autoRate && runRateProbes(sample, nbFrames)) { // the current sample was the last one replayed
+        return nbFrames;
+    }
+
+    if (m_dsdSymbol.pushSample(sample)) { // a symbol is retrieved
+        return dispatchSymbol();
+    }
+
+    return 0;
+}
+
+/** Same as processSample with the matched and ringing filters already applied (see DSDSymbolBank) */
+int DSDDecoder::processFilteredSample(short sample, short filteredSample, short ringingSample)
+{
+    m_sampleCount++; // the symbol bank feeds input samples directly
+    checkSquelch(sample);
+    int nbFrames;
+
+    if (m_autoRate && runRateProbes(sample, nbFrames)) { // the current sample was the last one replayed
+        return nbFrames;
+    }
+
+    if (m_dsdSymbol.pushFilteredSample(filteredSample, ringingSample)) {
+        return dispatchSymbol();
+    }
+
+    return 0;
+}
+
+int DSDDecoder::dispatchSymbol()
+{
+    // clear the ready flags around the dispatch so that every frame completion is counted
+    // even if the caller has not consumed the previous one yet
+    bool dvReady1 = m_mbeDVReady1;
+    bool dvReady2 = m_mbeDVReady2;
+    m_mbeDVReady1 = false;
+    m_mbeDVReady2 = false;
+
+    processSymbol();
+
+    int nbFrames = (m_mbeDVReady1 ? 1 : 0) + (m_mbeDVReady2 ? 1 : 0);
+    m_mbeDVReady1 = m_mbeDVReady1 || dvReady1;
+    m_mbeDVReady2 = m_mbeDVReady2 || dvReady2;
+    return nbFrames;
+}
+
+void DSDDecoder::processSymbol()
+{
+    switch (m_fsmState)
+    {
+    case DSDLookForSync:
+        m_sync = getFrameSync(); // -> -2: still looking, -1 not found, 0 and above: sync found
+
+        if (m_sync == -2) // -2 means no sync has been found at all
+        {
+            break; // still searching -> no change in FSM state
+        }
+        else if (m_sync == -1) // -1 means sync has been found but is invalid
+        {
+            //TRACE("DSDDecoder::run: invalid sync found: %d symbol %d (%d)\n", m_sync, m_state.symbolcnt, m_dsdSymbol.getSymbol());
+            resetFrameSync(); // go back searching
+        }
+        else // good sync found
+        {
+            //TRACE("DSDDecoder::run: good sync found: %d symbol %d (%d)\r\n", m_sync, m_state.symbolcnt, m_dsdSymbol.getSymbol());
+            m_fsmState = DSDSyncFound; // go to processing state next time
         }
+
+        break; // next
+    case DSDSyncFound:
+        m_syncType  = (DSDSyncType) m_sync;
+        //TRACE("DSDDecoder::run: before processFrameInit: symbol %d (%d)\n", m_state.symbolcnt, m_dsdSymbol.getSymbol());
+        processFrameInit();   // initiate the process of the frame which sync has been found. This will change FSM state
+        break;
+    case DSDprocessDMRvoice:
+        m_dsdDMR.processVoice();
+        break;
+    case DSDprocessDMRvoiceMS:
+        m_dsdDMR.processVoiceMS();
+        break;
+    case DSDprocessDMRdata:
+        m_dsdDMR.processData();
+        break;
+    case DSDprocessDMRdataMS:
+        m_dsdDMR.processDataMS();
+        break;
+    case DSDprocessDMRsyncOrSkip:
+        m_dsdDMR.processSyncOrSkip();
+        break;
+    case DSDprocessDMRSkipMS:
+        m_dsdDMR.processSkipMS();
+        break;
+    case DSDprocessDSTAR:
+        m_dsdDstar.process();
+        break;
+    case DSDprocessDSTAR_HD:
+        m_dsdDstar.processHD();
+        break;
+    case DSDprocessYSF:
+        m_dsdYSF.process();
+        break;
+    case DSDprocessDPMR:
+        m_dsdDPMR.process();
+        break;
+    case DSDprocessNXDN:
+        m_dsdNXDN.process();
+        break;
+    case DSDprocessP25p1:
+        m_dsdP25P1.process();
+        break;
+    case DSDprocessP25p1HD:
+        m_dsdP25P1.processHDU();
+        break;
+    default:
+        break;
     }
 }
 
@@ -668,7 +1106,7 @@ int DSDDecoder::getFrameSync()
     {
         DSDSync syncEngine;
         m_dmrBurstType = DSDDMR::DSDDMRBurstNone;
-        syncEngine.matchAll(m_dsdSymbol.getSyncDibitBack(DSDSync::m_history));
+        syncEngine.matchAll(m_dsdSymbol.getSyncHistory());
 
         if (m_opts.frame_p25p1 == 1)
         {
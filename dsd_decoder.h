@@ -24,7 +24,11 @@
 #include "dsd_state.h"
 #include "dsd_logger.h"
 #include "dsd_symbol.h"
+#include "dsd_resampler.h"
+#include "dsd_rateprobe.h"
+#include "dsd_discriminator.h"
 #include "dsd_mbe.h"
+#include "dsd_audiosink.h"
 #include "dmr.h"
 #include "ysf.h"
 #include "dpmr.h"
@@ -36,10 +40,15 @@
 
 
 #define DSD_SQUELCH_TIMEOUT_SAMPLES 960 // 200ms timeout after return to sync search
+#define DSD_AUTORATE_HOLD_SAMPLES 24000 // 500ms in sync search before the auto rate detection may change the symbol rate
 
 namespace DSDcc
 {
 
+class DSDVocoder;
+class DSDFrameRecorder;
+struct DSDFrameRecord;
+
 class DSDCC_API DSDDecoder
 {
     friend class DSDSymbol;
@@ -51,6 +60,7 @@ class DSDCC_API DSDDecoder
     friend class DSDdPMR;
     friend class DSDNXDN;
     friend class DSDP25P1; 
+    template<int N> friend class DSDSymbolBank;
 public:
     typedef enum
     {
@@ -64,7 +74,8 @@ public:
         DSDDecodeDMR,
         DSDDecodeX2TDMA,
         DSDDecodeDPMR,
-        DSDDecodeYSF
+        DSDDecodeYSF,
+        DSDDecodeAutoRate //!< as DSDDecodeAuto with sync search at the three symbol rates at once
     } DSDDecodeMode;
 
     typedef enum
@@ -161,11 +172,21 @@ public:
     ~DSDDecoder();
 
     void run(short sample);
+    /**
+     * Block ingestion. Returns the number of AMBE/IMBE frames (both slots) that became ready while processing the block.
+     * Only the last frame of each slot is kept (see getMbeDVFrame1 and getMbeDVFrame2) so when the frames are used
+     * the block must be shorter than the spacing of two frames of a slot else the earlier ones are lost.
+     * 5 ms blocks (as dsdccx uses) are safe with all modes.
+     */
+    int run(const short *samples, unsigned int nbSamples);
+    /** Complex baseband ingestion at the input rate. FM demodulated inside. Returns the number of AMBE/IMBE frames that became ready. Same block length limit as run */
+    int runIQ(const std::complex<float> *samples, unsigned int nbSamples);
     short getFilteredSample() const { return m_dsdSymbol.getFilteredSample(); }
     short getSymbolSyncSample() const { return m_dsdSymbol.getSymbolSyncSample(); }
 
     /** DVSI support */
 
+    /** Last AMBE/IMBE frame of the TDMA unique or first slot. Overwritten by the next one */
     const unsigned char *getMbeDVFrame1() const {
         return m_mbeDVFrame1;
     }
@@ -178,6 +199,7 @@ public:
         m_mbeDVReady1 = false;
     }
 
+    /** Last AMBE frame of the TDMA second slot. Overwritten by the next one */
     const unsigned char *getMbeDVFrame2() const {
         return m_mbeDVFrame2;
     }
@@ -190,28 +212,71 @@ public:
         m_mbeDVReady2 = false;
     }
 
-    /** MBElib support */
+    /**
+     * MBElib support. Audio is either polled with getAudio1/2 and resetAudio1/2 after running the decoder or
+     * pushed frame by frame to an audio sink. With an audio sink or the vocoder thread getAudio1/2 return no
+     * samples and the one second buffers of the polled output are not allocated.
+     */
+    void setAudioSink(DSDAudioSink *audioSink); //!< 0 to go back to polling. Call with the vocoder thread off or flushed
+    DSDAudioSink *getAudioSink() const { return m_audioSink; }
+    uint64_t getSampleCount() const { return m_sampleCount; } //!< input samples consumed so far (see DSDAudioSink::audioFrame)
 
     short *getAudio1(int& nbSamples)
     {
+        if (m_audioSink || m_vocoder)
+        {
+            nbSamples = 0;
+            return 0;
+        }
+
         return m_mbeDecoder1.getAudio(nbSamples);
     }
 
     void resetAudio1()
     {
-        m_mbeDecoder1.resetAudio();
+        if (!m_audioSink && !m_vocoder) {
+            m_mbeDecoder1.resetAudio();
+        }
     }
 
     short *getAudio2(int& nbSamples)
     {
+        if (m_audioSink || m_vocoder)
+        {
+            nbSamples = 0;
+            return 0;
+        }
+
         return m_mbeDecoder2.getAudio(nbSamples);
     }
 
     void resetAudio2()
     {
-        m_mbeDecoder2.resetAudio();
+        if (!m_audioSink && !m_vocoder) {
+            m_mbeDecoder2.resetAudio();
+        }
     }
 
+    /**
+     * Runs the AMBE/IMBE synthesis on a thread of its own (see DSDVocoder). The audio of each frame is
+     * then delivered from that thread to the audio sink. Error bars are not shown and the audio settings
+     * should be made before turning it on. Turning it off synthesizes the pending frames first.
+     * Frames are dropped when the thread falls behind unless waitWhenFull is set (file decoding).
+     */
+    void setVocoderThread(bool on, bool waitWhenFull = false);
+    bool getVocoderThread() const { return m_vocoder != 0; }
+    void flushVocoder();                          //!< returns when the frames extracted so far have been synthesized
+    unsigned int getVocoderDroppedFrames() const; //!< frames dropped because the vocoder thread fell behind
+
+    /**
+     * Records the vocoder frames with the call metadata to a DSDFrameRecorder for a deferred synthesis
+     * with synthesizeRecord. Frames are recorded whether mbelib is enabled or not so that recording with
+     * mbelib disabled (see enableMbelib) skips the synthesis entirely. The recorder is not owned. 0 stops.
+     */
+    void setFrameRecorder(DSDFrameRecorder *frameRecorder);
+    DSDFrameRecorder *getFrameRecorder() const { return m_frameRecorder; }
+    void synthesizeRecord(DSDFrameRecord& record); //!< synthesizes a recorded frame to the audio output of its slot. A session record resets the MBE parameters of both slots. Vocoder thread off
+
     //DSDOpts *getOpts() { return &m_opts; }
     DSDState *getState() { return &m_state; }
 
@@ -233,6 +298,7 @@ public:
     int getSymbolSyncQuality() const { return m_dsdSymbol.getSymbolSyncQuality(); }
     int getSamplesPerSymbol() const { return m_dsdSymbol.getSamplesPerSymbol(); }
     DSDRate getDataRate() const { return m_dataRate; };
+    bool getAutoRate() const { return m_autoRate; }
     bool getVoice1On() const { return m_voice1On; }
     bool getVoice2On() const { return m_voice2On; }
     void setTDMAStereo(bool tdmaStereo);
@@ -258,12 +324,18 @@ public:
     void setAudioGain(float gain);
     void setUvQuality(int uvquality);
     void setUpsampling(int upsampling);
+    bool setAudioRate(int audioRate); //!< audio output rate in S/s through the polyphase resampler (16000, 22050, 44100, 48000...). 0 (default) for 8000 times the upsampling factor. False if the rate is rejected (see isAudioRateSupported)
+    static bool isAudioRateSupported(int audioRate) { return DSDMBEDecoder::isAudioRateSupported(audioRate); } //!< at most 56000 S/s with a reasonable ratio to 8000 S/s
     void setStereo(bool on);
     void setInvertedXTDMA(bool on);
     void enableCosineFiltering(bool on);
     void enableAudioOut(bool on);
     void enableScanResumeAfterTDULCFrames(int nbFrames);
     void setDataRate(DSDRate dataRate);
+    bool setInputRate(int sampleRate); //!< input sample rate in S/s. Input is resampled to the 48 kS/s of the symbol chain unless it can be processed natively (see DSDSymbol::getChainRate). Minimum is 6 kS/s. False if the rate is rejected (see isInputRateSupported)
+    static bool isInputRateSupported(int sampleRate); //!< at least 6 kS/s and resamplable to 48 kS/s
+    void setIQDemodulation(float bandwidth, float maxDeviation); //!< channel bandwidth and maximum FM deviation in Hz for runIQ. Default 12500 and 2700
+    void setTimingRecovery(DSDSymbol::TimingRecovery timingRecovery); //!< Gardner timing runs the symbol chain at the input rate (9600 baud needs 19.2 kS/s)
     void setMyPoint(float lat, float lon) { m_myPoint.setLatLon(lat, lon); }
     void setSymbolPLLLock(bool pllLock) { m_dsdSymbol.setPLLLock(pllLock); }
     void setDMRBasicPrivacyKey(unsigned char key);
@@ -271,6 +343,8 @@ public:
     // parameter getters:
 
     int upsampling() const { return m_mbeDecoder1.getUpsamplingFactor(); }
+    int getAudioRate() const { return m_mbeDecoder1.getAudioRate(); }
+    int getInputRate() const { return m_inputResampler.getInRate(); }
 
     DSDMBERate getMbeRate() const { return m_mbeRate; }
     void setMbeRate(DSDMBERate mbeRate) { m_mbeRate = mbeRate; }
@@ -300,6 +374,16 @@ private:
     void noCarrier();
     void printFrameInfo();
     void processFrameInit();
+    void processSymbol();
+    int processSample(short sample);
+    int processFilteredSample(short sample, short filteredSample, short ringingSample);
+    int dispatchSymbol();
+    void checkSquelch(short sample);
+    void configureSymbolChain(int inputRate);
+    void enableAutoFrames(bool on); //!< protocols of the current data rate
+    void configureRateProbes();
+    bool runRateProbes(short sample, int& nbFrames);
+    void recordCallInfo(int slot); //!< call metadata of the frame being recorded
     static int comp(const void *a, const void *b);
     static int countDiff(const unsigned char *a, const unsigned char *b, unsigned char *t, unsigned int len);
 
@@ -316,9 +400,21 @@ private:
     char m_spectrum[64];
     int m_t;
     int m_squelchTimeoutCount;
+    int m_squelchTimeoutSamples; //!< DSD_SQUELCH_TIMEOUT_SAMPLES at the symbol chain rate
     int m_nxdnInterSyncCount;
     // Symbol extraction and operations
+    DSDResampler m_inputResampler; //!< input rate to the symbol chain rate
+    short m_resampled[8];          //!< resampler output for one input sample
+    DSDDiscriminator m_discriminator; //!< FM demodulator of runIQ
+    short m_discriminated[256];    //!< FM demodulator output block
     DSDSymbol m_dsdSymbol;
+    // Auto rate detection
+    bool m_autoRate;                //!< DSDDecodeAutoRate is on
+    DSDRateProbe m_rateProbe1;      //!< sync search at the first of the two other symbol rates
+    DSDRateProbe m_rateProbe2;      //!< sync search at the second of the two other symbol rates
+    int m_autoRateIdleSamples;      //!< chain samples spent in sync search. -1 when the probes are paused
+    int m_autoRateHoldSamples;      //!< DSD_AUTORATE_HOLD_SAMPLES at the symbol chain rate
+    short m_autoRateReplay[DSDRateProbe::m_maxHistory]; //!< probe history replayed after a symbol rate change
     // MBE decoder
     char ambe_fr[4][24];
     char imbe_fr[8][23];
@@ -326,6 +422,10 @@ private:
     DSDMBERate m_mbeRate;
     DSDMBEDecoder m_mbeDecoder1; //!< AMBE decoder for TDMA unique or first slot
     DSDMBEDecoder m_mbeDecoder2; //!< AMBE decoder for TDMA second slot
+    DSDVocoder *m_vocoder;       //!< synthesis thread. 0 when synthesis runs inline
+    DSDAudioSink *m_audioSink;   //!< frame by frame audio output. 0 for the polled output
+    uint64_t m_sampleCount;      //!< input samples consumed
+    DSDFrameRecorder *m_frameRecorder; //!< 0 when not recording
     // DVSI AMBE3000 serial device support
     unsigned char m_mbeDVFrame1[18]; //!< AMBE/IMBE encoded frame for TDMA unique or first slot
     bool m_mbeDVReady1;              //!< AMBE/IMBE encoded frame ready status for TDMA unique or first slot
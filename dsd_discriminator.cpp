@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#include "dsd_discriminator.h"
+#include "dsd_simd.h"
+
+namespace DSDcc
+{
+
+// atan(a) for a in [0,1] as a * P(a^2)
+static const float atanC0 =  0.99997726f;
+static const float atanC1 = -0.33262347f;
+static const float atanC2 =  0.19354346f;
+static const float atanC3 = -0.11643287f;
+static const float atanC4 =  0.05265332f;
+static const float atanC5 = -0.01172120f;
+
+const unsigned int DSDDiscriminator::m_blockSize;
+
+static short clip(float v)
+{
+    return v > 32767.0f ? 32767 : v < -32768.0f ? -32768 : (short) (v < 0.0f ? v - 0.5f : v + 0.5f);
+}
+
+static void discriminateScalar(const float *i, const float *q, short *out, unsigned int nbSamples, float scale)
+{
+    for (unsigned int k = 0; k < nbSamples; k++)
+    {
+        float re = i[k+1]*i[k] + q[k+1]*q[k]; // x[n].conj(x[n-1])
+        float im = q[k+1]*i[k] - i[k+1]*q[k];
+        out[k] = clip(scale * DSDDiscriminator::fastAtan2(im, re));
+    }
+}
+
+#ifdef DSD_SIMD_X86
+
+DSD_SIMD_TARGET("sse2")
+static void discriminateSSE2(const float *i, const float *q, short *out, unsigned int nbSamples, float scale)
+{
+    const __m128 absMask  = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 tiny     = _mm_set1_ps(1e-30f);
+    const __m128 halfPi   = _mm_set1_ps((float) (M_PI / 2.0));
+    const __m128 pi       = _mm_set1_ps((float) M_PI);
+    const __m128 vscale   = _mm_set1_ps(scale);
+    unsigned int k = 0;
+
+    for (; k + 4 <= nbSamples; k += 4)
+    {
+        __m128 i0 = _mm_loadu_ps(i + k);
+        __m128 q0 = _mm_loadu_ps(q + k);
+        __m128 i1 = _mm_loadu_ps(i + k + 1);
+        __m128 q1 = _mm_loadu_ps(q + k + 1);
+        __m128 x = _mm_add_ps(_mm_mul_ps(i1, i0), _mm_mul_ps(q1, q0));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(q1, i0), _mm_mul_ps(i1, q0));
+
+        __m128 ax = _mm_and_ps(x, absMask);
+        __m128 ay = _mm_and_ps(y, absMask);
+        __m128 a = _mm_div_ps(_mm_min_ps(ax, ay), _mm_add_ps(_mm_max_ps(ax, ay), tiny));
+        __m128 s = _mm_mul_ps(a, a);
+        __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(atanC5), s), _mm_set1_ps(atanC4));
+        r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(atanC3));
+        r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(atanC2));
+        r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(atanC1));
+        r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(atanC0));
+        r = _mm_mul_ps(r, a);
+
+        __m128 mask = _mm_cmpgt_ps(ay, ax); // octant swap
+        r = _mm_or_ps(_mm_and_ps(mask, _mm_sub_ps(halfPi, r)), _mm_andnot_ps(mask, r));
+        mask = _mm_cmplt_ps(x, _mm_setzero_ps()); // left half plane
+        r = _mm_or_ps(_mm_and_ps(mask, _mm_sub_ps(pi, r)), _mm_andnot_ps(mask, r));
+        r = _mm_or_ps(r, _mm_and_ps(y, signMask)); // r is positive so this copies the sign of y
+
+        __m128i v = _mm_cvtps_epi32(_mm_mul_ps(r, vscale));
+        _mm_storel_epi64((__m128i *) (out + k), _mm_packs_epi32(v, v)); // saturated to 16 bits
+    }
+
+    discriminateScalar(i + k, q + k, out + k, nbSamples - k, scale);
+}
+
+#endif // DSD_SIMD_X86
+
+DSDDiscriminator::DSDDiscriminator() :
+        m_sampleRate(0),
+        m_bandwidth(0.0f),
+        m_maxDeviation(0.0f),
+        m_scale(0.0f),
+        m_nbTaps(0),
+        m_paddedTaps(0),
+        m_coeffs(0),
+        m_historyI(0),
+        m_historyQ(0),
+        m_index(0)
+{
+    m_dot = DSDFIRFilter::selectKernel();
+    m_discriminate = discriminateScalar;
+#ifdef DSD_SIMD_X86
+    if (DSDSimd::hasSSE2()) {
+        m_discriminate = discriminateSSE2;
+    }
+#endif
+    configure(48000, 12500.0f, 2700.0f);
+}
+
+DSDDiscriminator::~DSDDiscriminator()
+{
+    delete[] m_historyQ;
+    delete[] m_historyI;
+    delete[] m_coeffs;
+}
+
+/**
+ * The filter is cut at half the channel bandwidth (at most 0.45 times the sample rate) with about
+ * 16 taps per ratio of sample rate to bandwidth which makes a transition band of about a third of
+ * the bandwidth.
+ */
+void DSDDiscriminator::configure(int sampleRate, float bandwidth, float maxDeviation)
+{
+    m_sampleRate = sampleRate;
+    m_bandwidth = bandwidth;
+    m_maxDeviation = maxDeviation;
+    m_scale = 16384.0f / (float) (2.0 * M_PI * maxDeviation / sampleRate);
+
+    delete[] m_historyQ;
+    delete[] m_historyI;
+    delete[] m_coeffs;
+
+    m_nbTaps = 2 * (int) (8.0f * sampleRate / bandwidth) + 1;
+    m_paddedTaps = (m_nbTaps + 7) & ~7;
+    m_coeffs = new float[m_paddedTaps];
+    m_historyI = new float[2*m_nbTaps + 8];
+    m_historyQ = new float[2*m_nbTaps + 8];
+    memset(m_coeffs, 0, m_paddedTaps * sizeof(float));
+
+    double fc = bandwidth / (2.0 * sampleRate);
+    fc = fc > 0.45 ? 0.45 : fc;
+    double center = (m_nbTaps - 1) / 2.0;
+    double sum = 0.0;
+
+    for (int n = 0; n < m_nbTaps; n++)
+    {
+        double x = n - center;
+        double sinc = x == 0.0 ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * n / (m_nbTaps - 1)) + 0.08 * cos(4.0 * M_PI * n / (m_nbTaps - 1));
+        m_coeffs[n] = (float) (sinc * window); // symmetrical so order does not matter
+        sum += m_coeffs[n];
+    }
+
+    for (int n = 0; n < m_nbTaps; n++) { // unity gain so that the angle is not affected by the filter
+        m_coeffs[n] /= sum;
+    }
+
+    reset();
+}
+
+void DSDDiscriminator::reset()
+{
+    memset(m_historyI, 0, (2*m_nbTaps + 8) * sizeof(float));
+    memset(m_historyQ, 0, (2*m_nbTaps + 8) * sizeof(float));
+    m_index = 0;
+    m_filteredI[m_blockSize] = 0.0f;
+    m_filteredQ[m_blockSize] = 0.0f;
+}
+
+void DSDDiscriminator::run(const std::complex<float> *in, short *out, unsigned int nbSamples)
+{
+    while (nbSamples > 0)
+    {
+        unsigned int n = nbSamples < m_blockSize ? nbSamples : m_blockSize;
+
+        // carry the last filtered sample of the previous block over to the head
+        m_filteredI[0] = m_filteredI[m_blockSize];
+        m_filteredQ[0] = m_filteredQ[m_blockSize];
+
+        for (unsigned int k = 0; k < n; k++)
+        {
+            push(in[k].real(), in[k].imag());
+            m_filteredI[k+1] = m_dot(m_coeffs, &m_historyI[m_index], m_paddedTaps);
+            m_filteredQ[k+1] = m_dot(m_coeffs, &m_historyQ[m_index], m_paddedTaps);
+        }
+
+        m_discriminate(m_filteredI, m_filteredQ, out, n, m_scale);
+
+        m_filteredI[m_blockSize] = m_filteredI[n];
+        m_filteredQ[m_blockSize] = m_filteredQ[n];
+        in += n;
+        out += n;
+        nbSamples -= n;
+    }
+}
+
+float DSDDiscriminator::fastAtan2(float y, float x)
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float a = (ax < ay ? ax : ay) / ((ax < ay ? ay : ax) + 1e-30f);
+    float s = a * a;
+    float r = (((((atanC5*s + atanC4)*s + atanC3)*s + atanC2)*s + atanC1)*s + atanC0) * a;
+
+    if (ay > ax) {
+        r = (float) (M_PI / 2.0) - r;
+    }
+
+    if (x < 0.0f) {
+        r = (float) M_PI - r;
+    }
+
+    return y < 0.0f ? -r : r;
+}
+
+} // namespace DSDcc
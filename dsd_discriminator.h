@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_DISCRIMINATOR_H_
+#define DSDCC_DSD_DISCRIMINATOR_H_
+
+#include <complex>
+
+#include "dsd_fir.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * FM demodulator for complex baseband input. The channel low pass filter is a Blackman windowed sinc
+ * applied to I and Q with the FIR SIMD kernels. The polar discriminator takes the angle of x[n].conj(x[n-1])
+ * with a polynomial atan2 approximation vectorized with SSE2 when available. Output is scaled so that the
+ * maximum deviation gives half the full scale and is saturated to 16 bits without de-emphasis.
+ */
+class DSDCC_API DSDDiscriminator
+{
+public:
+    DSDDiscriminator();
+    ~DSDDiscriminator();
+
+    void configure(int sampleRate, float bandwidth, float maxDeviation); //!< bandwidth is the channel width in Hz. maxDeviation in Hz
+    void reset();
+    void run(const std::complex<float> *in, short *out, unsigned int nbSamples); //!< one output sample per input sample
+
+    float getBandwidth() const { return m_bandwidth; }
+    float getMaxDeviation() const { return m_maxDeviation; }
+
+    static float fastAtan2(float y, float x); //!< maximum error 2e-6 rad
+
+    typedef void (*DiscriminatorKernel)(const float *i, const float *q, short *out, unsigned int nbSamples, float scale); //!< i and q start with the previous sample
+
+private:
+    DSDDiscriminator(const DSDDiscriminator&);            //!< not copyable: owns its buffers
+    DSDDiscriminator& operator=(const DSDDiscriminator&); //!< not implemented
+
+    void push(float i, float q)
+    {
+        m_historyI[m_index] = i;
+        m_historyI[m_index + m_nbTaps] = i;
+        m_historyQ[m_index] = q;
+        m_historyQ[m_index + m_nbTaps] = q;
+        m_index = (m_index + 1 == m_nbTaps) ? 0 : m_index + 1;
+    }
+
+    static const unsigned int m_blockSize = 256;
+
+    int m_sampleRate;
+    float m_bandwidth;
+    float m_maxDeviation;
+    float m_scale;       //!< output units per radian
+    int m_nbTaps;
+    int m_paddedTaps;    //!< number of taps rounded up to the SIMD width (extra coefficients are zero)
+    float *m_coeffs;
+    float *m_historyI;   //!< 2 * m_nbTaps samples plus padding
+    float *m_historyQ;
+    int m_index;         //!< next write index in the histories
+    float m_filteredI[m_blockSize + 1]; //!< filtered block preceded by the last sample of the previous block
+    float m_filteredQ[m_blockSize + 1];
+    DSDFIRFilter::DotKernel m_dot;
+    DiscriminatorKernel m_discriminate;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_DISCRIMINATOR_H_ */
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <assert.h>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#include "dsd_fft.h"
+
+namespace DSDcc
+{
+
+DSDFFT::DSDFFT(int size) :
+        m_size(size)
+{
+    assert((size >= 2) && ((size & (size - 1)) == 0));
+
+    m_twiddles = new std::complex<float>[size/2];
+    m_bitReverse = new int[size];
+
+    for (int k = 0; k < size/2; k++) {
+        m_twiddles[k] = std::complex<float>((float) cos(2.0 * M_PI * k / size), (float) -sin(2.0 * M_PI * k / size));
+    }
+
+    int nbBits = 0;
+
+    while ((1 << nbBits) < size) {
+        nbBits++;
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        int r = 0;
+
+        for (int b = 0; b < nbBits; b++) {
+            r |= ((i >> b) & 1) << (nbBits - 1 - b);
+        }
+
+        m_bitReverse[i] = r;
+    }
+}
+
+DSDFFT::~DSDFFT()
+{
+    delete[] m_bitReverse;
+    delete[] m_twiddles;
+}
+
+void DSDFFT::transform(std::complex<float> *data, bool inverse) const
+{
+    for (int i = 0; i < m_size; i++)
+    {
+        int r = m_bitReverse[i];
+
+        if (r > i) {
+            std::swap(data[i], data[r]);
+        }
+    }
+
+    for (int half = 1; half < m_size; half <<= 1)
+    {
+        int stride = m_size / (2*half); // twiddle index step
+
+        for (int start = 0; start < m_size; start += 2*half)
+        {
+            for (int k = 0; k < half; k++)
+            {
+                std::complex<float> w = m_twiddles[k*stride];
+                std::complex<float> t = (inverse ? std::conj(w) : w) * data[start + k + half];
+                data[start + k + half] = data[start + k] - t;
+                data[start + k] += t;
+            }
+        }
+    }
+}
+
+} // namespace DSDcc
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_FFT_H_
+#define DSDCC_DSD_FFT_H_
+
+#include <complex>
+
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * In place iterative radix-2 complex FFT with precomputed twiddles and bit reversal permutation.
+ * Neither direction is scaled.
+ */
+class DSDCC_API DSDFFT
+{
+public:
+    explicit DSDFFT(int size); //!< size must be a power of 2
+    ~DSDFFT();
+
+    void transform(std::complex<float> *data, bool inverse) const;
+    int getSize() const { return m_size; }
+
+private:
+    int m_size;
+    std::complex<float> *m_twiddles; //!< exp(-j.2.pi.k/size) for k in [0, size/2[
+    int *m_bitReverse;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_FFT_H_ */
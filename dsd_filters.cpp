@@ -30,6 +30,9 @@ const float DSDFilters::ngain = 7.423339364f;
 const float DSDFilters::nxgain = 15.95930463f;
 const float DSDFilters::dmrgain = 6.82973073748f;
 const float DSDFilters::dpmrgain = 14.6083498224f;
+const float DSDFilters::dmr24gain = 3.4297578428f;
+const float DSDFilters::dpmr24gain = 7.3056600403f;
+const float DSDFilters::dpmr12gain = 3.6530240461f;
 
 // DMR filter - DSD original for 4800 baud - root raised cosine alpha=0.2 Ts = 6000 S/s Fc = 48kHz - zero at boundaries
 const float DSDFilters::xcoeffs[] =
@@ -136,15 +139,44 @@ const float DSDFilters::dpmrcoeffs[] =
         0.0275919612f, 0.0232592816f, 0.0179185547f, 0.0119748846f,
         0.0058388841f, -0.0000983004f};
 
-DSDFilters::DSDFilters()
+// DMR filter - root raised cosine alpha=0.7 Ts = 6650 S/s Fc = 24 kHz - every other tap of dmrcoeffs
+const float DSDFilters::dmr24coeffs[] =
+{0.0301506278f, 0.0159662432f, -0.0216605133f, -0.0528141756f, -0.0428325003f, 0.0147202645f, 0.0816392577f,
+0.0957187780f, 0.0206194642f, -0.1107569268f, -0.1981519842f, -0.1308939560f, 0.1325685970f, 0.5182530574f,
+0.8623526878f, 1.0000000000f, 0.8623526878f, 0.5182530574f, 0.1325685970f, -0.1308939560f, -0.1981519842f,
+-0.1107569268f, 0.0206194642f, 0.0957187780f, 0.0816392577f, 0.0147202645f, -0.0428325003f, -0.0528141756f,
+-0.0216605133f, 0.0159662432f, 0.0301506278f};
+
+// dPMR filter - root raised cosine alpha=0.2 Ts = 3325 S/s Fc = 24 kHz - every other tap of dpmrcoeffs
+const float DSDFilters::dpmr24coeffs[] =
+{0.0058388841f, 0.0179185547f, 0.0275919612f, 0.0317982965f, 0.0283911865f, 0.0168387650f, -0.0013831396f,
+-0.0228442151f, -0.0427067804f, -0.0557003599f, -0.0573462646f, -0.0451732069f, -0.0196350217f, 0.0155246961f,
+0.0536202583f, 0.0861006725f, 0.1042112035f, 0.1009496091f, 0.0729301774f, 0.0217462748f, -0.0455148664f,
+-0.1168095612f, -0.1767350726f, -0.2089805758f, -0.1992367833f, -0.1380470370f, -0.0230554989f, 0.1398131936f,
+0.3365341927f, 0.5465745033f, 0.7456885564f, 0.9094784589f, 1.0171250045f, 1.0546479089f, 1.0171250045f,
+0.9094784589f, 0.7456885564f, 0.5465745033f, 0.3365341927f, 0.1398131936f, -0.0230554989f, -0.1380470370f,
+-0.1992367833f, -0.2089805758f, -0.1767350726f, -0.1168095612f, -0.0455148664f, 0.0217462748f, 0.0729301774f,
+0.1009496091f, 0.1042112035f, 0.0861006725f, 0.0536202583f, 0.0155246961f, -0.0196350217f, -0.0451732069f,
+-0.0573462646f, -0.0557003599f, -0.0427067804f, -0.0228442151f, -0.0013831396f, 0.0168387650f, 0.0283911865f,
+0.0317982965f, 0.0275919612f, 0.0179185547f, 0.0058388841f};
+
+// dPMR filter - root raised cosine alpha=0.2 Ts = 3325 S/s Fc = 12 kHz - every fourth tap of dpmrcoeffs
+const float DSDFilters::dpmr12coeffs[] =
+{0.0179185547f, 0.0317982965f, 0.0168387650f, -0.0228442151f, -0.0557003599f, -0.0451732069f, 0.0155246961f,
+0.0861006725f, 0.1009496091f, 0.0217462748f, -0.1168095612f, -0.2089805758f, -0.1380470370f, 0.1398131936f,
+0.5465745033f, 0.9094784589f, 1.0546479089f, 0.9094784589f, 0.5465745033f, 0.1398131936f, -0.1380470370f,
+-0.2089805758f, -0.1168095612f, 0.0217462748f, 0.1009496091f, 0.0861006725f, 0.0155246961f, -0.0451732069f,
+-0.0557003599f, -0.0228442151f, 0.0168387650f, 0.0317982965f, 0.0179185547f};
+
+DSDFilters::DSDFilters() :
+        m_xFilter(xcoeffs, NZEROS+1, ngain),
+        m_nxFilter(nxcoeffs, NXZEROS+1, nxgain),
+        m_dmrFilter(dmrcoeffs, NZEROS+1, dmrgain),
+        m_dpmrFilter(dpmrcoeffs, NXZEROS+1, dpmrgain),
+        m_dmr24Filter(dmr24coeffs, NZEROS/2+1, dmr24gain),
+        m_dpmr24Filter(dpmr24coeffs, NXZEROS/2, dpmr24gain),
+        m_dpmr12Filter(dpmr12coeffs, NXZEROS/4, dpmr12gain)
 {
-    for (int i=0; i < NZEROS+1; i++) {
-        xv[i] = 0.0f;
-    }
-
-    for (int i=0; i < NXZEROS+1; i++) {
-        nxv[i] = 0.0f;
-    }
 }
 
 DSDFilters::~DSDFilters()
@@ -153,65 +185,75 @@ DSDFilters::~DSDFilters()
 
 short DSDFilters::dmr_filter(short sample) // all 4800 baud filters for now
 {
-    return dsd_input_filter(sample, 3);
+    return m_dmrFilter.run(sample);
 }
 
 short DSDFilters::nxdn_filter(short sample) // all 2400 baud filters for now
 {
-    return dsd_input_filter(sample, 4);
+    return m_dpmrFilter.run(sample);
 }
 
-short DSDFilters::dsd_input_filter(short sample, int mode)
+short DSDFilters::dmr24_filter(short sample)
+{
+    return m_dmr24Filter.run(sample);
+}
+
+short DSDFilters::nxdn24_filter(short sample)
+{
+    return m_dpmr24Filter.run(sample);
+}
+
+short DSDFilters::nxdn12_filter(short sample)
+{
+    return m_dpmr12Filter.run(sample);
+}
+
+void DSDFilters::dmr_filter(const short *in, short *out, unsigned int nbSamples)
+{
+    m_dmrFilter.run(in, out, nbSamples);
+}
+
+void DSDFilters::nxdn_filter(const short *in, short *out, unsigned int nbSamples)
+{
+    m_dpmrFilter.run(in, out, nbSamples);
+}
+
+DSDFIRFilter& DSDFilters::matchedFilter(int sampleRate, int baudRate)
 {
-    float sum;
-    int i;
-    float gain;
-    int zeros;
-    float *v;
-    const float *coeffs;
+    switch (sampleRate)
+    {
+    case 24000:
+        if (baudRate == 2400) {
+            return m_dpmr24Filter;
+        } else {
+            return m_dmr24Filter;
+        }
+    case 12000:
+        return m_dpmr12Filter;
+    default: // 48000
+        if (baudRate == 2400) {
+            return m_dpmrFilter; // 6.25 kHz for 2400 baud
+        } else {
+            return m_dmrFilter;  // 12.5 kHz for 4800 and 9600 baud
+        }
+    }
+}
 
+short DSDFilters::dsd_input_filter(short sample, int mode)
+{
     switch (mode)
     {
     case 1:
-        gain = ngain;
-        v = xv;
-        coeffs = xcoeffs;
-        zeros = NZEROS;
-        break;
+        return m_xFilter.run(sample);
     case 2:
-        gain = nxgain;
-        v = nxv;
-        coeffs = nxcoeffs;
-        zeros = NXZEROS;
-        break;
+        return m_nxFilter.run(sample);
     case 3:
-        gain = dmrgain;
-        v = xv;
-        coeffs = dmrcoeffs;
-        zeros = NZEROS;
-        break;
+        return m_dmrFilter.run(sample);
     case 4:
-        gain = dpmrgain;
-        v = nxv;
-        coeffs = dpmrcoeffs;
-        zeros = NXZEROS;
-        break;
+        return m_dpmrFilter.run(sample);
     default:
         return sample;
     }
-
-    for (i = 0; i < zeros; i++) {
-        v[i] = v[i + 1];
-    }
-
-    v[zeros] = sample; // unfiltered sample in
-    sum = 0.0f;
-
-    for (i = 0; i <= zeros; i++) {
-        sum += (coeffs[i] * v[i]);
-    }
-
-    return (short) (sum / gain); // filtered sample out
 }
 
 // ====================================================================
@@ -238,18 +280,31 @@ void DSDSecondOrderRecursiveFilter::setR(float r)
 	init();
 }
 
-short DSDSecondOrderRecursiveFilter::run(short sample)
+void DSDSecondOrderRecursiveFilter::run(const short *in, short *out, unsigned int nbSamples)
 {
-	m_v[0] = ((1.0f - m_r) * (float) sample) + (2.0f * m_r * (float)cos(2.0*M_PI*m_frequencyRatio) * m_v[1]) - (m_r * m_r * m_v[2]);
-	float y = m_v[0] - m_v[2];
-	m_v[2] = m_v[1];
-	m_v[1] = m_v[0];
+    float v1 = m_v[1];
+    float v2 = m_v[2];
 
-	return (short) y;
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        float v0 = (m_b0 * (float) in[i]) + (m_a1 * v1) - (m_a2 * v2);
+        out[i] = (short) (v0 - v2);
+        v2 = v1;
+        v1 = v0;
+    }
+
+    m_v[0] = v1;
+    m_v[1] = v1;
+    m_v[2] = v2;
 }
 
+/** The coefficients are computed here once rather than for each sample */
 void DSDSecondOrderRecursiveFilter::init()
 {
+	m_b0 = 1.0f - m_r;
+	m_a1 = 2.0f * m_r * (float) cos(2.0*M_PI*m_frequencyRatio);
+	m_a2 = m_r * m_r;
+
 	for (int i = 0; i < 3; i++)
 	{
 		m_v[i] = 0.0f;
@@ -21,6 +21,7 @@
 #define NXZEROS 134
 
 #include "iirfilter.h"
+#include "dsd_fir.h"
 #include "export.h"
 
 namespace DSDcc
@@ -40,14 +41,31 @@ public:
     static const float dmrcoeffs[];
     static const float dpmrgain;
     static const float dpmrcoeffs[];
+    static const float dmr24gain;
+    static const float dmr24coeffs[];
+    static const float dpmr24gain;
+    static const float dpmr24coeffs[];
+    static const float dpmr12gain;
+    static const float dpmr12coeffs[];
 
     short dsd_input_filter(short sample, int mode);
     short dmr_filter(short sample);
     short nxdn_filter(short sample);
+    short dmr24_filter(short sample);  //!< dmr_filter at 24 kS/s for 4800 baud
+    short nxdn24_filter(short sample); //!< nxdn_filter at 24 kS/s for 2400 baud
+    short nxdn12_filter(short sample); //!< nxdn_filter at 12 kS/s for 2400 baud
+    void dmr_filter(const short *in, short *out, unsigned int nbSamples);
+    void nxdn_filter(const short *in, short *out, unsigned int nbSamples);
+    DSDFIRFilter& matchedFilter(int sampleRate, int baudRate); //!< symbol chain matched filter for the sample and symbol rates of DSDSymbol::isNativeRate
 
 private:
-    float xv[NZEROS+1];
-    float nxv[NXZEROS+1];
+    DSDFIRFilter m_xFilter;    //!< mode 1
+    DSDFIRFilter m_nxFilter;   //!< mode 2
+    DSDFIRFilter m_dmrFilter;  //!< mode 3
+    DSDFIRFilter m_dpmrFilter; //!< mode 4
+    DSDFIRFilter m_dmr24Filter;  //!< mode 3 at 24 kS/s
+    DSDFIRFilter m_dpmr24Filter; //!< mode 4 at 24 kS/s
+    DSDFIRFilter m_dpmr12Filter; //!< mode 4 at 12 kS/s
 };
 
 /**
@@ -62,13 +80,32 @@ public:
 
     void setFrequencies(float samplingFrequency, float centerFrequency);
     void setR(float r);
-    short run(short sample);
+    float getR() const { return m_r; }
+    float getFrequencyRatio() const { return m_frequencyRatio; }
+    float getB0() const { return m_b0; }
+    float getA1() const { return m_a1; }
+    float getA2() const { return m_a2; }
+
+    short run(short sample)
+    {
+        m_v[0] = (m_b0 * (float) sample) + (m_a1 * m_v[1]) - (m_a2 * m_v[2]);
+        float y = m_v[0] - m_v[2];
+        m_v[2] = m_v[1];
+        m_v[1] = m_v[0];
+
+        return (short) y;
+    }
+
+    void run(const short *in, short *out, unsigned int nbSamples); //!< block mode. in and out may be the same buffer
 
 private:
     void init();
 
     float m_r;
     float m_frequencyRatio;
+    float m_b0; //!< 1 - r
+    float m_a1; //!< 2.r.cos(2.pi.f)
+    float m_a2; //!< r^2
     float m_v[3];
 };
 
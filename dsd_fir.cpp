@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "dsd_fir.h"
+#include "dsd_simd.h"
+
+namespace DSDcc
+{
+
+static float dotScalar(const float *a, const float *b, int n)
+{
+    float sum = 0.0f;
+
+    for (int i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+#ifdef DSD_SIMD_X86
+
+DSD_SIMD_TARGET("sse2")
+static float dotSSE2(const float *a, const float *b, int n)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    for (int i = 0; i < n; i += 8)
+    {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+    return _mm_cvtss_f32(acc0);
+}
+
+DSD_SIMD_TARGET("avx2")
+static float dotAVX2(const float *a, const float *b, int n)
+{
+    __m256 acc = _mm256_setzero_ps();
+
+    for (int i = 0; i < n; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+#endif // DSD_SIMD_X86
+
+DSDFIRFilter::DotKernel DSDFIRFilter::selectKernel()
+{
+#ifdef DSD_SIMD_X86
+    if (DSDSimd::hasAVX2()) {
+        return dotAVX2;
+    }
+
+    if (DSDSimd::hasSSE2()) {
+        return dotSSE2;
+    }
+#endif
+    return dotScalar;
+}
+
+const char *DSDFIRFilter::getKernelName()
+{
+    DotKernel dot = selectKernel();
+#ifdef DSD_SIMD_X86
+    if (dot == dotAVX2) {
+        return "AVX2";
+    } else if (dot == dotSSE2) {
+        return "SSE2";
+    }
+#endif
+    return "scalar";
+}
+
+DSDFIRFilter::DSDFIRFilter(const float *coeffs, int nbTaps, float gain) :
+        m_nbTaps(nbTaps),
+        m_paddedTaps((nbTaps + 7) & ~7),
+        m_gain(gain),
+        m_index(0)
+{
+    m_coeffs = new float[m_paddedTaps];
+    m_history = new float[2*m_nbTaps + 8];
+    memset(m_coeffs, 0, m_paddedTaps * sizeof(float));
+    memcpy(m_coeffs, coeffs, m_nbTaps * sizeof(float));
+    m_dot = selectKernel();
+    reset();
+}
+
+DSDFIRFilter::~DSDFIRFilter()
+{
+    delete[] m_history;
+    delete[] m_coeffs;
+}
+
+void DSDFIRFilter::reset()
+{
+    memset(m_history, 0, (2*m_nbTaps + 8) * sizeof(float));
+    m_index = 0;
+}
+
+short DSDFIRFilter::run(short sample)
+{
+    push(sample);
+    return (short) (m_dot(m_coeffs, &m_history[m_index], m_paddedTaps) / m_gain);
+}
+
+void DSDFIRFilter::run(const short *in, short *out, unsigned int nbSamples)
+{
+    DotKernel dot = m_dot;
+
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        push(in[i]);
+        out[i] = (short) (dot(m_coeffs, &m_history[m_index], m_paddedTaps) / m_gain);
+    }
+}
+
+} // namespace DSDcc
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_FIR_H_
+#define DSDCC_DSD_FIR_H_
+
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Real FIR filter over a double length circular history so that the taps window is always
+ * contiguous in memory. The dot product kernel (scalar, SSE2 or AVX2) is selected at run time.
+ */
+class DSDCC_API DSDFIRFilter
+{
+public:
+    DSDFIRFilter(const float *coeffs, int nbTaps, float gain);
+    ~DSDFIRFilter();
+
+    short run(short sample);
+    void run(const short *in, short *out, unsigned int nbSamples); //!< block mode. in and out may be the same buffer
+    void reset();
+    int getNbTaps() const { return m_nbTaps; }
+    const float *getCoeffs() const { return m_coeffs; } //!< oldest sample first
+    float getGain() const { return m_gain; }
+
+    typedef float (*DotKernel)(const float *a, const float *b, int n); //!< n must be a multiple of 8
+
+    static const char *getKernelName();
+    static DotKernel selectKernel(); //!< best dot product kernel for this CPU
+
+private:
+    DSDFIRFilter(const DSDFIRFilter&);            //!< not copyable: owns its buffers
+    DSDFIRFilter& operator=(const DSDFIRFilter&); //!< not implemented
+
+    void push(short sample)
+    {
+        m_history[m_index] = sample;
+        m_history[m_index + m_nbTaps] = sample;
+        m_index = (m_index + 1 == m_nbTaps) ? 0 : m_index + 1;
+    }
+
+    int m_nbTaps;       //!< number of taps
+    int m_paddedTaps;   //!< number of taps rounded up to the SIMD width (extra coefficients are zero)
+    float m_gain;
+    float *m_coeffs;    //!< coefficients oldest sample first
+    float *m_history;   //!< 2 * m_nbTaps samples plus padding
+    int m_index;        //!< next write index. Window is m_history[m_index .. m_index + m_nbTaps - 1]
+    DotKernel m_dot;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_FIR_H_ */
@@ -0,0 +1,416 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "dsd_framerecorder.h"
+#include "timeutil.h"
+
+namespace DSDcc
+{
+
+const unsigned char DSDFrameRecorder::m_magic[4] = {'D', 'S', 'D', 'V'};
+
+/** number of frame bits recorded for the MBE rate */
+static int frameBits(DSDDecoder::DSDMBERate mbeRate)
+{
+    if (mbeRate == DSDDecoder::DSDMBERate7200x4400) {
+        return 8*23;
+    } else if (mbeRate == DSDDecoder::DSDMBERate7100x4400) {
+        return 7*24;
+    } else {
+        return 4*24;
+    }
+}
+
+/** number of data bits recorded for the MBE rate. 0 if the rate has no data synthesis */
+static int dataBits(DSDDecoder::DSDMBERate mbeRate)
+{
+    if (mbeRate == DSDDecoder::DSDMBERate4400) {
+        return 88;
+    } else if ((mbeRate == DSDDecoder::DSDMBERate2400) || (mbeRate == DSDDecoder::DSDMBERate2450)) {
+        return 49;
+    } else {
+        return 0;
+    }
+}
+
+DSDFrameRecorder::DSDFrameRecorder() :
+        m_fp(0),
+        m_lastTimestamp(0),
+        m_nbFrames(0)
+{
+    m_slotSynthesized[0] = true;
+    m_slotSynthesized[1] = true;
+    m_callText[0][0] = '\0';
+    m_callText[1][0] = '\0';
+}
+
+DSDFrameRecorder::~DSDFrameRecorder()
+{
+    close();
+}
+
+bool DSDFrameRecorder::open(const char *filename)
+{
+    close();
+    m_fp = fopen(filename, "a+b");
+
+    if (!m_fp) {
+        return false;
+    }
+
+    unsigned char header[5];
+    fseek(m_fp, 0, SEEK_SET);
+
+    if (fread(header, 1, 5, m_fp) == 0) // new file
+    {
+        fwrite(m_magic, 1, 4, m_fp);
+        fputc(m_version, m_fp);
+    }
+    else if ((memcmp(header, m_magic, 4) != 0) || (header[4] != m_version))
+    {
+        close();
+        return false;
+    }
+
+    fseek(m_fp, 0, SEEK_END); // switch to writing
+    m_nbFrames = 0;
+    return true;
+}
+
+void DSDFrameRecorder::close()
+{
+    if (m_fp)
+    {
+        fclose(m_fp);
+        m_fp = 0;
+    }
+}
+
+void DSDFrameRecorder::writeSession(uint64_t timestamp, int inputRate)
+{
+    if (!m_fp) {
+        return;
+    }
+
+    fputc(DSDFrameRecord::RecordSession << 4, m_fp);
+    writeVarint(timestamp);
+    writeVarint(inputRate);
+    writeVarint(TimeUtil::nowms());
+    m_lastTimestamp = timestamp;
+    m_slotSynthesized[0] = true;
+    m_slotSynthesized[1] = true;
+    m_callText[0][0] = '\0';
+    m_callText[1][0] = '\0';
+}
+
+void DSDFrameRecorder::writeFrame(int slot, uint64_t timestamp, DSDDecoder::DSDMBERate mbeRate, int uvquality, char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24])
+{
+    if (!m_fp) {
+        return;
+    }
+
+    writeHeader(DSDFrameRecord::RecordFrame, slot, timestamp);
+    fputc(mbeRate, m_fp);
+    fputc(uvquality, m_fp);
+
+    if (mbeRate == DSDDecoder::DSDMBERate7200x4400) {
+        writeBits(&imbe_fr[0][0], frameBits(mbeRate));
+    } else if (mbeRate == DSDDecoder::DSDMBERate7100x4400) {
+        writeBits(&imbe7100_fr[0][0], frameBits(mbeRate));
+    } else {
+        writeBits(&ambe_fr[0][0], frameBits(mbeRate));
+    }
+
+    m_slotSynthesized[slot] = true;
+    m_nbFrames++;
+}
+
+void DSDFrameRecorder::writeData(int slot, uint64_t timestamp, DSDDecoder::DSDMBERate mbeRate, int uvquality, char imbe_data[88], char ambe_data[49])
+{
+    int nbBits = dataBits(mbeRate);
+
+    if (!m_fp || (nbBits == 0)) { // not synthesized either
+        return;
+    }
+
+    writeHeader(DSDFrameRecord::RecordData, slot, timestamp);
+    fputc(mbeRate, m_fp);
+    fputc(uvquality, m_fp);
+    writeBits(mbeRate == DSDDecoder::DSDMBERate4400 ? imbe_data : ambe_data, nbBits);
+    m_slotSynthesized[slot] = true;
+    m_nbFrames++;
+}
+
+void DSDFrameRecorder::writeInit(int slot, uint64_t timestamp)
+{
+    if (!m_fp || !m_slotSynthesized[slot]) { // the MBE parameters are still in their initial state
+        return;
+    }
+
+    writeHeader(DSDFrameRecord::RecordInit, slot, timestamp);
+    m_slotSynthesized[slot] = false;
+}
+
+void DSDFrameRecorder::writeCallInfo(int slot, uint64_t timestamp, DSDDecoder::DSDSyncType syncType, const char *text)
+{
+    if (!m_fp || (strncmp(text, m_callText[slot], DSDFrameRecord::m_maxTextSize) == 0)) {
+        return;
+    }
+
+    strncpy(m_callText[slot], text, DSDFrameRecord::m_maxTextSize);
+    m_callText[slot][DSDFrameRecord::m_maxTextSize] = '\0';
+    int length = strlen(m_callText[slot]);
+
+    writeHeader(DSDFrameRecord::RecordCallInfo, slot, timestamp);
+    fputc(syncType, m_fp);
+    fputc(length, m_fp);
+    fwrite(m_callText[slot], 1, length, m_fp);
+}
+
+void DSDFrameRecorder::writeHeader(DSDFrameRecord::RecordType type, int slot, uint64_t timestamp)
+{
+    fputc((type << 4) | (slot & 0xF), m_fp);
+    writeVarint(timestamp > m_lastTimestamp ? timestamp - m_lastTimestamp : 0);
+    m_lastTimestamp = timestamp;
+}
+
+void DSDFrameRecorder::writeVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        fputc((int) (value & 0x7F) | 0x80, m_fp);
+        value >>= 7;
+    }
+
+    fputc((int) value, m_fp);
+}
+
+void DSDFrameRecorder::writeBits(const char *bits, int nbBits)
+{
+    unsigned char bytes[23];
+    int nbBytes = (nbBits + 7) / 8;
+    memset(bytes, 0, nbBytes);
+
+    for (int i = 0; i < nbBits; i++)
+    {
+        if (bits[i] & 1) {
+            bytes[i>>3] |= 0x80 >> (i & 7);
+        }
+    }
+
+    fwrite(bytes, 1, nbBytes, m_fp);
+}
+
+DSDFrameReader::DSDFrameReader() :
+        m_fp(0),
+        m_lastTimestamp(0),
+        m_corrupted(false)
+{
+}
+
+DSDFrameReader::~DSDFrameReader()
+{
+    close();
+}
+
+bool DSDFrameReader::open(const char *filename)
+{
+    close();
+    m_fp = fopen(filename, "rb");
+
+    if (!m_fp) {
+        return false;
+    }
+
+    unsigned char header[5];
+
+    if ((fread(header, 1, 5, m_fp) != 5)
+        || (memcmp(header, DSDFrameRecorder::m_magic, 4) != 0)
+        || (header[4] != DSDFrameRecorder::m_version))
+    {
+        close();
+        return false;
+    }
+
+    m_lastTimestamp = 0;
+    m_corrupted = false;
+    return true;
+}
+
+void DSDFrameReader::close()
+{
+    if (m_fp)
+    {
+        fclose(m_fp);
+        m_fp = 0;
+    }
+}
+
+bool DSDFrameReader::next(DSDFrameRecord& record)
+{
+    if (!m_fp || m_corrupted) {
+        return false;
+    }
+
+    int tag = fgetc(m_fp);
+
+    if (tag == EOF) {
+        return false;
+    }
+
+    uint64_t timestamp;
+    m_corrupted = true; // until the record is complete
+
+    if (!readVarint(timestamp)) {
+        return false;
+    }
+
+    record.m_type = (DSDFrameRecord::RecordType) (tag >> 4);
+    record.m_slot = tag & 0xF;
+
+    if (record.m_slot > 1) {
+        return false;
+    }
+
+    if (record.m_type == DSDFrameRecord::RecordSession)
+    {
+        uint64_t inputRate;
+
+        if (!readVarint(inputRate) || !readVarint(record.m_time)) {
+            return false;
+        }
+
+        record.m_inputRate = (int) inputRate;
+        record.m_timestamp = timestamp;
+    }
+    else
+    {
+        record.m_timestamp = m_lastTimestamp + timestamp;
+    }
+
+    m_lastTimestamp = record.m_timestamp;
+
+    switch (record.m_type)
+    {
+    case DSDFrameRecord::RecordSession:
+    case DSDFrameRecord::RecordInit:
+        break;
+    case DSDFrameRecord::RecordFrame:
+    case DSDFrameRecord::RecordData:
+    {
+        int mbeRate = fgetc(m_fp);
+        int uvquality = fgetc(m_fp);
+
+        if ((mbeRate == EOF) || (uvquality == EOF)) {
+            return false;
+        }
+
+        record.m_mbeRate = (DSDDecoder::DSDMBERate) mbeRate;
+        record.m_uvquality = uvquality;
+
+        char *bits;
+        int nbBits;
+
+        if (record.m_type == DSDFrameRecord::RecordData)
+        {
+            bits = record.m_mbeRate == DSDDecoder::DSDMBERate4400 ? record.m_imbe_data : record.m_ambe_data;
+            nbBits = dataBits(record.m_mbeRate);
+        }
+        else if (record.m_mbeRate == DSDDecoder::DSDMBERate7200x4400)
+        {
+            bits = &record.m_imbe_fr[0][0];
+            nbBits = frameBits(record.m_mbeRate);
+        }
+        else if (record.m_mbeRate == DSDDecoder::DSDMBERate7100x4400)
+        {
+            bits = &record.m_imbe7100_fr[0][0];
+            nbBits = frameBits(record.m_mbeRate);
+        }
+        else
+        {
+            bits = &record.m_ambe_fr[0][0];
+            nbBits = frameBits(record.m_mbeRate);
+        }
+
+        if ((nbBits == 0) || !readBits(bits, nbBits)) {
+            return false;
+        }
+        break;
+    }
+    case DSDFrameRecord::RecordCallInfo:
+    {
+        int syncType = fgetc(m_fp);
+        int length = fgetc(m_fp);
+
+        if ((syncType == EOF) || (length == EOF) || (length > DSDFrameRecord::m_maxTextSize)
+            || (fread(record.m_text, 1, length, m_fp) != (size_t) length))
+        {
+            return false;
+        }
+
+        record.m_syncType = (DSDDecoder::DSDSyncType) syncType;
+        record.m_text[length] = '\0';
+        break;
+    }
+    default:
+        return false;
+    }
+
+    m_corrupted = false;
+    return true;
+}
+
+bool DSDFrameReader::readVarint(uint64_t& value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int c = fgetc(m_fp);
+
+        if (c == EOF) {
+            return false;
+        }
+
+        value |= ((uint64_t) (c & 0x7F)) << shift;
+
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool DSDFrameReader::readBits(char *bits, int nbBits)
+{
+    unsigned char bytes[23];
+    int nbBytes = (nbBits + 7) / 8;
+
+    if (fread(bytes, 1, nbBytes, m_fp) != (size_t) nbBytes) {
+        return false;
+    }
+
+    for (int i = 0; i < nbBits; i++) {
+        bits[i] = (bytes[i>>3] >> (7 - (i & 7))) & 1;
+    }
+
+    return true;
+}
+
+} // namespace DSDcc
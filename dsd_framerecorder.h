@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_FRAMERECORDER_H_
+#define DSDCC_DSD_FRAMERECORDER_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "dsd_decoder.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * One record of a vocoder frame recording as read back by DSDFrameReader. Only the fields of the
+ * record type are valid and of the frame arrays only the one used by the MBE rate.
+ */
+struct DSDCC_API DSDFrameRecord
+{
+    typedef enum
+    {
+        RecordNone,
+        RecordSession,  //!< start of a recording session: input rate and wall clock time
+        RecordFrame,    //!< AMBE/IMBE frame (DSDMBEDecoder::processFrame)
+        RecordData,     //!< AMBE/IMBE data without FEC (DSDMBEDecoder::processData)
+        RecordInit,     //!< reset of the MBE parameters (DSDMBEDecoder::initMbeParms)
+        RecordCallInfo  //!< call metadata: IDs or callsigns of the signal the next frames belong to
+    } RecordType;
+
+    static const int m_maxTextSize = 127;
+
+    RecordType m_type;
+    int m_slot;                        //!< 0 for TDMA unique or first slot, 1 for second slot
+    uint64_t m_timestamp;              //!< decoder input sample count when the record was written
+    DSDDecoder::DSDMBERate m_mbeRate;  //!< frame and data
+    int m_uvquality;                   //!< frame and data
+    char m_imbe_fr[8][23];
+    char m_ambe_fr[4][24];
+    char m_imbe7100_fr[7][24];
+    char m_imbe_data[88];
+    char m_ambe_data[49];
+    DSDDecoder::DSDSyncType m_syncType; //!< call info
+    char m_text[m_maxTextSize+1];       //!< call info
+    int m_inputRate;                    //!< session: decoder input rate to turn timestamps into time
+    uint64_t m_time;                    //!< session: epoch in milliseconds when the session started
+};
+
+/**
+ * Records the vocoder frames extracted by a decoder instead of, or along with, synthesizing them (see
+ * DSDDecoder::setFrameRecorder). The recording can be synthesized later with DSDFrameReader and
+ * DSDDecoder::synthesizeRecord giving the same audio as live synthesis with the same audio settings.
+ *
+ * The file is append only. It starts with the "DSDV" magic and a version byte then each record is:
+ *   - a tag byte with the record type in the high nibble and the slot in the low nibble
+ *   - the timestamp as a varint difference to the previous record (absolute for the session record)
+ *   - session: varints of the input rate and the epoch in milliseconds
+ *   - frame and data: MBE rate and unvoiced quality bytes then the frame bits packed MSB first
+ *     (12 bytes for AMBE, 23 for IMBE 7200x4400, 21 for IMBE 7100x4400, 11 or 7 for IMBE or AMBE data)
+ *   - call info: sync type and length bytes then the text
+ *
+ * A frame takes about 17 bytes that is less than 1 kB per second of speech.
+ */
+class DSDCC_API DSDFrameRecorder
+{
+public:
+    DSDFrameRecorder();
+    ~DSDFrameRecorder();
+
+    bool open(const char *filename); //!< appends to an existing recording. False if it cannot be opened or is not a recording
+    void close();
+    bool isOpen() const { return m_fp != 0; }
+    unsigned int getNbFrames() const { return m_nbFrames; }
+
+    void writeSession(uint64_t timestamp, int inputRate); //!< done by DSDDecoder::setFrameRecorder
+    void writeFrame(int slot, uint64_t timestamp, DSDDecoder::DSDMBERate mbeRate, int uvquality, char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24]);
+    void writeData(int slot, uint64_t timestamp, DSDDecoder::DSDMBERate mbeRate, int uvquality, char imbe_data[88], char ambe_data[49]);
+    void writeInit(int slot, uint64_t timestamp);  //!< skipped when no frame of the slot was written since the last one
+    void writeCallInfo(int slot, uint64_t timestamp, DSDDecoder::DSDSyncType syncType, const char *text); //!< skipped when the text of the slot did not change
+
+    static const unsigned char m_magic[4];
+    static const unsigned char m_version = 1;
+
+private:
+    void writeHeader(DSDFrameRecord::RecordType type, int slot, uint64_t timestamp);
+    void writeVarint(uint64_t value);
+    void writeBits(const char *bits, int nbBits);
+
+    FILE *m_fp;
+    uint64_t m_lastTimestamp;
+    bool m_slotSynthesized[2]; //!< frames were written since the last init record of the slot
+    char m_callText[2][DSDFrameRecord::m_maxTextSize+1];
+    unsigned int m_nbFrames;
+};
+
+/**
+ * Reads back a recording made with DSDFrameRecorder record by record.
+ */
+class DSDCC_API DSDFrameReader
+{
+public:
+    DSDFrameReader();
+    ~DSDFrameReader();
+
+    bool open(const char *filename); //!< false if it cannot be opened or is not a recording
+    void close();
+    bool next(DSDFrameRecord& record); //!< false at the end of the recording or at a truncated or corrupted record
+    bool isCorrupted() const { return m_corrupted; }
+
+private:
+    bool readVarint(uint64_t& value);
+    bool readBits(char *bits, int nbBits);
+
+    FILE *m_fp;
+    uint64_t m_lastTimestamp;
+    bool m_corrupted;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_FRAMERECORDER_H_ */
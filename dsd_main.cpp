@@ -17,13 +17,18 @@
 #include <stdio.h>
 #include <signal.h>
 #include <unistd.h>
+#include <getopt.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <math.h>
 
 #include "dsd_decoder.h"
 #include "dsd_upsample.h"
+#include "dsd_framerecorder.h"
+#include "timeutil.h"
 
 #ifdef DSD_USE_SERIALDV
 #include "dvcontroller.h"
@@ -50,7 +55,7 @@ private:
 
 void Mixer::mix(unsigned int size1, unsigned int size2, short *channel1, short *channel2)
 {
-    unsigned int m_mixSize = std::max(size1, size2);
+    m_mixSize = std::max(size1, size2);
 
     if (m_mixSize > m_mixSizeMax)
     {
@@ -59,7 +64,7 @@ void Mixer::mix(unsigned int size1, unsigned int size2, short *channel1, short *
             delete[] m_mix;
         }
 
-        m_mix = new short[m_mixSizeMax];
+        m_mix = new short[m_mixSize];
         m_mixSizeMax = m_mixSize;
     }
 
@@ -79,6 +84,155 @@ void Mixer::mix(unsigned int size1, unsigned int size2, short *channel1, short *
     }
 }
 
+/**
+ * Input samples in blocks. Regular files are memory mapped and the blocks point directly into the mapping.
+ * Anything else (pipes, stdin, devices) or a file that cannot be mapped is read in large chunks.
+ * Blocks are always made of whole samples.
+ */
+class InputReader
+{
+public:
+    InputReader(int fd, unsigned int sampleSize);
+    ~InputReader();
+    const char *next(unsigned int maxSamples, unsigned int& nbSamples); //!< nbSamples is 0 at the end of input
+    bool isMapped() const { return m_map != 0; }
+
+private:
+    int m_fd;
+    unsigned int m_sampleSize;
+    char *m_map;           //!< memory mapped file or 0
+    size_t m_mapSize;
+    size_t m_mapOffset;
+    char *m_buffer;        //!< chunk buffer when not mapped
+    size_t m_bufferSize;
+    size_t m_bufferStart;  //!< first byte not yet delivered
+    size_t m_bufferEnd;    //!< end of valid data
+    bool m_eof;
+};
+
+InputReader::InputReader(int fd, unsigned int sampleSize) :
+    m_fd(fd),
+    m_sampleSize(sampleSize),
+    m_map(0),
+    m_mapSize(0),
+    m_mapOffset(0),
+    m_buffer(0),
+    m_bufferSize(0),
+    m_bufferStart(0),
+    m_bufferEnd(0),
+    m_eof(false)
+{
+    struct stat st;
+
+    if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0))
+    {
+        void *map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (map != MAP_FAILED)
+        {
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            m_map = (char *) map;
+            m_mapSize = st.st_size - (st.st_size % sampleSize);
+            return;
+        }
+    }
+
+    m_bufferSize = 65536 * sampleSize;
+    m_buffer = new char[m_bufferSize];
+}
+
+InputReader::~InputReader()
+{
+    if (m_map) {
+        munmap(m_map, m_mapSize);
+    }
+
+    delete[] m_buffer;
+}
+
+const char *InputReader::next(unsigned int maxSamples, unsigned int& nbSamples)
+{
+    if (m_map)
+    {
+        size_t available = (m_mapSize - m_mapOffset) / m_sampleSize;
+        nbSamples = available < maxSamples ? available : maxSamples;
+        const char *samples = &m_map[m_mapOffset];
+        m_mapOffset += nbSamples * m_sampleSize;
+        return samples;
+    }
+
+    if ((m_bufferEnd - m_bufferStart < m_sampleSize) && !m_eof)
+    {
+        // move the partial sample left over to the front and refill
+        size_t remainder = m_bufferEnd - m_bufferStart;
+        memmove(m_buffer, &m_buffer[m_bufferStart], remainder);
+        m_bufferStart = 0;
+        m_bufferEnd = remainder;
+
+        while (m_bufferEnd < m_sampleSize)
+        {
+            ssize_t result = read(m_fd, &m_buffer[m_bufferEnd], m_bufferSize - m_bufferEnd);
+
+            if (result > 0)
+            {
+                m_bufferEnd += result;
+            }
+            else if ((result < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            else
+            {
+                if (result < 0) {
+                    fprintf(stderr, "Error reading input\n");
+                }
+
+                m_eof = true;
+                break;
+            }
+        }
+    }
+
+    size_t available = (m_bufferEnd - m_bufferStart) / m_sampleSize;
+    nbSamples = available < maxSamples ? available : maxSamples;
+    const char *samples = &m_buffer[m_bufferStart];
+    m_bufferStart += nbSamples * m_sampleSize;
+    return samples;
+}
+
+/**
+ * Audio output of the vocoder thread. Frames of the selected slots are written as they come
+ */
+class AudioWriter : public DSDcc::DSDAudioSink
+{
+public:
+    AudioWriter() : m_fd(-1), m_slots(1) {}
+    void init(int fd, int slots) { m_fd = fd; m_slots = slots; }
+    virtual void audioFrame(int slot, const short *samples, int nbSamples, uint64_t timestamp);
+
+private:
+    int m_fd;
+    int m_slots;
+};
+
+void AudioWriter::audioFrame(int slot, const short *samples, int nbSamples, uint64_t timestamp __attribute__((unused)))
+{
+    if (((m_slots >> slot) & 1) == 0) {
+        return;
+    }
+
+    int result = write(m_fd, (const void *) samples, sizeof(short) * nbSamples);
+
+    if (result < 0)
+    {
+        fprintf(stderr, "Error writing to output\n");
+    }
+    else if ((unsigned int) result != sizeof(short) * nbSamples)
+    {
+        fprintf(stderr, "Written %d out of %d audio samples\n", result/2, nbSamples);
+    }
+}
+
 static void usage ();
 static void sigfun (int sig);
 
@@ -102,11 +256,17 @@ void usage()
     fprintf(stderr, "Input/Output options:\n");
     fprintf(stderr, "  -i <device>   Audio input device (default is /dev/audio, - for piped stdin)\n");
     fprintf(stderr, "  -o <device>   Audio output device (default is /dev/audio, - for stdout)\n");
+    fprintf(stderr, "  -c            Input is complex baseband: interleaved I/Q 32 bit floats. FM demodulated internally\n");
+    fprintf(stderr, "  -C <bw>:<dev> Channel bandwidth and maximum deviation in Hz for complex input. Default 12500:2700\n");
+    fprintf(stderr, "  -r <num>      Input sample rate in S/s (default 48000). 24000 and 12000 (2400 baud only) are processed\n");
+    fprintf(stderr, "                natively, other rates are resampled to 48000\n");
     fprintf(stderr, "  -g <num>      Audio output gain (default = 0 = auto, disable = -1)\n");
     fprintf(stderr, "  -U <num>      Audio output upsampling\n");
     fprintf(stderr, "                0: no upsampling (8k) default\n");
     fprintf(stderr, "                6: normal upsampling to 48k\n");
     fprintf(stderr, "                7: 7x upsampling to trade audio drops against bad audio quality\n");
+    fprintf(stderr, "  --audio-rate <num> Audio output rate in S/s (e.g. 16000, 22050, 44100, 48000) through the\n");
+    fprintf(stderr, "                polyphase resampler instead of -U upsampling. At most 56000\n");
     fprintf(stderr, "  -n            Do not send synthesized speech to audio output device\n");
     fprintf(stderr, "  -L <filename> Log messages to file with file name <filename>. Default is stderr\n");
     fprintf(stderr, "                If file name is invalid messages will go to stderr\n");
@@ -114,6 +274,12 @@ void usage()
     fprintf(stderr, "                Formatted messages contain traffic information such as IDs and callsigns\n");
     fprintf(stderr, "                Fields and their column position depend on the frame type\n");
     fprintf(stderr, "  -m <float>    Formatted messages refresh rate in seconds. Default is 0.1\n");
+    fprintf(stderr, "  --bench       Report the number of input samples processed per second at the end\n");
+    fprintf(stderr, "  --vocoder-thread Synthesize speech on a separate thread. With -T 3 the two slots are\n");
+    fprintf(stderr, "                written one frame after the other instead of mixed\n");
+    fprintf(stderr, "  --record <filename> Append the vocoder frames with call information to <filename> for a\n");
+    fprintf(stderr, "                later synthesis with dsdccsynth\n");
+    fprintf(stderr, "  --record-only Do not synthesize speech while recording (see --record)\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Scanner control options:\n");
     fprintf(stderr,
@@ -125,6 +291,7 @@ void usage()
     fprintf(stderr, "     1          4800 bauds (default)\n");
     fprintf(stderr, "     2          9800 bauds\n");
     fprintf(stderr, "  -fa           Auto-detect frame type (default)\n");
+    fprintf(stderr, "  -fA           Auto-detect frame type and symbol rate (2400, 4800 and 9600 baud searched at once)\n");
     fprintf(stderr, "  -fr           Decode only DMR/MOTOTRBO\n");
     fprintf(stderr, "  -fd           Decode only D-STAR\n");
     fprintf(stderr, "  -fm           Decode only DPMR Tier 1 or 2 (6.25 kHz)\n");
@@ -153,6 +320,8 @@ void usage()
     fprintf(stderr, "                This is useful when status messages (see -M option) contain geographical data\n");
     fprintf(stderr, "                Practically this is only applicable to D-Star\n");
     fprintf(stderr, "  -x            Disable symbol PLL lock\n");
+    fprintf(stderr, "  -G            Use fractional (Gardner) symbol timing recovery. The input is not resampled\n");
+    fprintf(stderr, "                to 48k (see -r option) unless there are less than 2 samples per symbol\n");
     fprintf(stderr, "  -k <num>      Number of Basic Privacy key for DMR [1..255]\n");
     fprintf(stderr, "\n");
     exit(0);
@@ -190,6 +359,14 @@ int main(int argc, char **argv)
     std::string dvSerialDevice;
 #endif
     int slots = 1;
+    bool iqInput = false;
+    bool bench = false;
+    bool vocoderThread = false;
+    char record_file[1023];
+    record_file[0] = '\0';
+    bool recordOnly = false;
+    DSDcc::DSDFrameRecorder frameRecorder;
+    AudioWriter audioWriter;
     Mixer mixer;
     float lat = 0.0f;
     float lon = 0.0f;
@@ -199,12 +376,43 @@ int main(int argc, char **argv)
     exitflag = 0;
     signal(SIGINT, sigfun);
 
-    while ((c = getopt(argc, argv,
-            "hHep:qtv:i:o:g:nR:f:u:U:lL:D:d:T:M:m:P:Q:xk:")) != -1)
+    static const struct option longOptions[] = {
+        {"bench", no_argument, 0, 'B'},
+        {"vocoder-thread", no_argument, 0, 'V'},
+        {"audio-rate", required_argument, 0, 'A'},
+        {"record", required_argument, 0, 'W'},
+        {"record-only", no_argument, 0, 'O'},
+        {0, 0, 0, 0}
+    };
+
+    while ((c = getopt_long(argc, argv,
+            "hHep:qtv:i:o:r:g:nR:f:u:U:lL:D:d:T:M:m:P:Q:xk:GcC:", longOptions, 0)) != -1)
     {
         opterr = 0;
         switch (c)
         {
+        case 'B':
+            bench = true;
+            break;
+        case 'V':
+            vocoderThread = true;
+            break;
+        case 'A':
+            int audioRate;
+            sscanf(optarg, "%d", &audioRate);
+            if ((audioRate > 0) && !dsdDecoder.setAudioRate(audioRate))
+            {
+                fprintf(stderr, "Audio rate %d S/s is not supported. Aborting\n", audioRate);
+                return 0;
+            }
+            break;
+        case 'W':
+            strncpy(record_file, (const char *) optarg, 1023);
+            record_file[1022] = '\0';
+            break;
+        case 'O':
+            recordOnly = true;
+            break;
         case 'h':
             usage();
             exit(0);
@@ -270,6 +478,15 @@ int main(int argc, char **argv)
             strncpy(out_file, (const char *) optarg, 1023);
             out_file[1022] = '\0';
             break;
+        case 'r':
+            int inputRate;
+            sscanf(optarg, "%d", &inputRate);
+            if (!dsdDecoder.setInputRate(inputRate))
+            {
+                fprintf(stderr, "Input rate %d S/s is not supported. Aborting\n", inputRate);
+                return 0;
+            }
+            break;
 #ifdef DSD_USE_SERIALDV
         case 'D':
             strncpy(serialDevice, (const char *) optarg, 16);
@@ -317,6 +534,10 @@ int main(int argc, char **argv)
             {
                 dsdDecoder.setDecodeMode(DSDcc::DSDDecoder::DSDDecodeAuto, true);
             }
+            else if (optarg[0] == 'A') // auto detect with symbol rate
+            {
+                dsdDecoder.setDecodeMode(DSDcc::DSDDecoder::DSDDecodeAutoRate, true);
+            }
             else if (optarg[0] == 'r') // DMR/MOTOTRBO
             {
                 dsdDecoder.setDecodeMode(DSDcc::DSDDecoder::DSDDecodeDMR, true);
@@ -376,6 +597,18 @@ int main(int argc, char **argv)
         case 'x':
             dsdDecoder.setSymbolPLLLock(false);
             break;
+        case 'G':
+            dsdDecoder.setTimingRecovery(DSDcc::DSDSymbol::TimingGardner);
+            break;
+        case 'c':
+            iqInput = true;
+            break;
+        case 'C':
+            float bandwidth, deviation;
+            if (sscanf(optarg, "%f:%f", &bandwidth, &deviation) == 2) {
+                dsdDecoder.setIQDemodulation(bandwidth, deviation);
+            }
+            break;
         case 'k':
             int key_number;
             sscanf(optarg, "%u", &key_number);
@@ -449,6 +682,30 @@ int main(int argc, char **argv)
     }
 #endif
 
+    if (vocoderThread)
+    {
+        audioWriter.init(out_file_fd, slots);
+        dsdDecoder.setAudioSink(&audioWriter);
+        dsdDecoder.setVocoderThread(true, true); // output is a stream: never drop frames
+    }
+
+    if (record_file[0] != '\0')
+    {
+        if (frameRecorder.open(record_file))
+        {
+            fprintf(stderr, "Recording vocoder frames to %s\n", record_file);
+            dsdDecoder.setFrameRecorder(&frameRecorder);
+
+            if (recordOnly) {
+                dsdDecoder.enableMbelib(false);
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Cannot open %s for recording\n", record_file);
+        }
+    }
+
     int formattext_nsamples;
 
     if (formattext_file[0] == 0)
@@ -457,7 +714,7 @@ int main(int argc, char **argv)
     }
     else
     {
-        formattext_nsamples = 48000.0f * formattext_refresh;
+        formattext_nsamples = dsdDecoder.getInputRate() * formattext_refresh;
         formattext_fp = fopen(formattext_file, "w");
 
         if (!formattext_fp)
@@ -467,22 +724,48 @@ int main(int argc, char **argv)
     }
 
     int formattext_sample_count = 0;
+    InputReader inputReader(in_file_fd, iqInput ? sizeof(std::complex<float>) : sizeof(short));
+    uint64_t benchStartUs = DSDcc::TimeUtil::nowus();
+    uint64_t benchSamples = 0;
+
+    if (inputReader.isMapped()) {
+        fprintf(stderr, "Input is memory mapped\n");
+    }
 
     while (exitflag == 0)
     {
-        short sample;
         int nbAudioSamples1 = 0, nbAudioSamples2 = 0;
         short *audioSamples1, *audioSamples2;
 
-        int result = read(in_file_fd, (void *) &sample, sizeof(short));
+        int result;
+        unsigned int maxSamples = 4096;
+        unsigned int nbSamples;
+
+        if ((formattext_nsamples > 0) && (formattext_nsamples + 1 - formattext_sample_count < (int) maxSamples)) { // block ends where the status text is due
+            maxSamples = formattext_nsamples + 1 - formattext_sample_count;
+        }
 
-        if (result == 0)
+#ifdef DSD_USE_SERIALDV
+        if (dvController.isOpen() && (dsdDecoder.getInputRate() / 200 < (int) maxSamples)) { // 5 ms blocks so that a slot has at most one DV frame per block
+            maxSamples = dsdDecoder.getInputRate() / 200;
+        }
+#endif
+
+        const char *samples = inputReader.next(maxSamples, nbSamples);
+
+        if (nbSamples == 0)
         {
             fprintf(stderr, "No more input\n");
             break;
         }
 
-        dsdDecoder.run(sample);
+        if (iqInput) {
+            dsdDecoder.runIQ((const std::complex<float> *) samples, nbSamples);
+        } else {
+            dsdDecoder.run((const short *) samples, nbSamples);
+        }
+
+        benchSamples += nbSamples;
 
 #ifdef DSD_USE_SERIALDV
         if (dvController.isOpen())
@@ -592,11 +875,9 @@ int main(int argc, char **argv)
 
         if (formattext_nsamples > 0)
         {
-            if (formattext_sample_count < formattext_nsamples)
-            {
-                formattext_sample_count++;
-            }
-            else
+            formattext_sample_count += nbSamples;
+
+            if (formattext_sample_count > formattext_nsamples)
             {
                 dsdDecoder.formatStatusText(formattext);
                 fputs(formattext, formattext_fp);
@@ -606,6 +887,25 @@ int main(int argc, char **argv)
         }
     }
 
+    dsdDecoder.setVocoderThread(false); // synthesizes the remaining frames
+
+    if (frameRecorder.isOpen())
+    {
+        dsdDecoder.setFrameRecorder(0);
+        frameRecorder.close();
+        fprintf(stderr, "Recorded %u vocoder frames\n", frameRecorder.getNbFrames());
+    }
+
+    if (bench)
+    {
+        double elapsed = (DSDcc::TimeUtil::nowus() - benchStartUs) / 1e6;
+        fprintf(stderr, "Processed %llu samples in %.3f s: %.0f samples/s (%.1f times real time)\n",
+                (unsigned long long) benchSamples,
+                elapsed,
+                elapsed > 0.0 ? benchSamples / elapsed : 0.0,
+                elapsed > 0.0 ? (benchSamples / (double) dsdDecoder.getInputRate()) / elapsed : 0.0);
+    }
+
     if (formattext_fp)
     {
         fclose(formattext_fp);
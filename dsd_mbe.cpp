@@ -18,6 +18,9 @@
 #include <math.h>
 #include "dsd_mbe.h"
 #include "dsd_decoder.h"
+#include "dsd_vocoder.h"
+#include "dsd_framerecorder.h"
+#include "dsd_simd.h"
 
 #define DSD_USE_MBELIB
 
@@ -28,22 +31,161 @@
 namespace DSDcc
 {
 
-DSDMBEDecoder::DSDMBEDecoder(DSDDecoder *dsdDecoder) :
+const int DSDMBEDecoder::m_maxAudioRate;
+
+static float absMaxScalar(const float *in, int nbSamples)
+{
+    float max = 0.0f;
+
+    for (int n = 0; n < nbSamples; n++)
+    {
+        float v = fabsf(in[n]);
+        max = v > max ? v : max;
+    }
+
+    return max;
+}
+
+static void gainRampScalar(float *buf, int nbSamples, float gain, float gainDelta)
+{
+    for (int n = 0; n < nbSamples; n++) {
+        buf[n] = (gain + ((float) n * gainDelta)) * buf[n];
+    }
+}
+
+/** Truncates to 16 bits after clipping at +/-32760 as the original per sample code did */
+static void audioOutScalar(const float *in, short *out, int nbSamples, float gain, float gainDelta, bool stereo, short leftMask, short rightMask)
+{
+    for (int n = 0; n < nbSamples; n++)
+    {
+        float v = (gain + ((float) n * gainDelta)) * in[n];
+        v = v < 32760.0f ? v : 32760.0f;
+        v = v > -32760.0f ? v : -32760.0f;
+        short s = (short) v;
+
+        if (stereo)
+        {
+            out[2*n] = s & leftMask;
+            out[2*n+1] = s & rightMask;
+        }
+        else
+        {
+            out[n] = s;
+        }
+    }
+}
+
+#ifdef DSD_SIMD_X86
+
+DSD_SIMD_TARGET("sse2")
+static float absMaxSSE2(const float *in, int nbSamples)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 max = _mm_setzero_ps();
+    int n = 0;
+
+    for (; n + 4 <= nbSamples; n += 4) {
+        max = _mm_max_ps(max, _mm_and_ps(_mm_loadu_ps(in + n), absMask));
+    }
+
+    max = _mm_max_ps(max, _mm_movehl_ps(max, max));
+    max = _mm_max_ss(max, _mm_shuffle_ps(max, max, 1));
+    float tail = absMaxScalar(in + n, nbSamples - n);
+    float m = _mm_cvtss_f32(max);
+    return tail > m ? tail : m;
+}
+
+DSD_SIMD_TARGET("sse2")
+static void gainRampSSE2(float *buf, int nbSamples, float gain, float gainDelta)
+{
+    const __m128 vgain = _mm_set1_ps(gain);
+    const __m128 vdelta = _mm_set1_ps(gainDelta);
+    __m128i index = _mm_set_epi32(3, 2, 1, 0);
+    int n = 0;
+
+    for (; n + 4 <= nbSamples; n += 4)
+    {
+        __m128 g = _mm_add_ps(vgain, _mm_mul_ps(_mm_cvtepi32_ps(index), vdelta));
+        _mm_storeu_ps(buf + n, _mm_mul_ps(g, _mm_loadu_ps(buf + n)));
+        index = _mm_add_epi32(index, _mm_set1_epi32(4));
+    }
+
+    for (; n < nbSamples; n++) {
+        buf[n] = (gain + ((float) n * gainDelta)) * buf[n];
+    }
+}
+
+/** Same operations as audioOutScalar 8 samples at a time. The pack saturation is a no-op after the clip */
+DSD_SIMD_TARGET("sse2")
+static void audioOutSSE2(const float *in, short *out, int nbSamples, float gain, float gainDelta, bool stereo, short leftMask, short rightMask)
+{
+    const __m128 vgain = _mm_set1_ps(gain);
+    const __m128 vdelta = _mm_set1_ps(gainDelta);
+    const __m128 hi = _mm_set1_ps(32760.0f);
+    const __m128 lo = _mm_set1_ps(-32760.0f);
+    const __m128i vleft = _mm_set1_epi16(leftMask);
+    const __m128i vright = _mm_set1_epi16(rightMask);
+    __m128i index = _mm_set_epi32(3, 2, 1, 0);
+    int n = 0;
+
+    for (; n + 8 <= nbSamples; n += 8)
+    {
+        __m128 g0 = _mm_add_ps(vgain, _mm_mul_ps(_mm_cvtepi32_ps(index), vdelta));
+        index = _mm_add_epi32(index, _mm_set1_epi32(4));
+        __m128 g1 = _mm_add_ps(vgain, _mm_mul_ps(_mm_cvtepi32_ps(index), vdelta));
+        index = _mm_add_epi32(index, _mm_set1_epi32(4));
+        __m128 v0 = _mm_max_ps(_mm_min_ps(_mm_mul_ps(g0, _mm_loadu_ps(in + n)), hi), lo);
+        __m128 v1 = _mm_max_ps(_mm_min_ps(_mm_mul_ps(g1, _mm_loadu_ps(in + n + 4)), hi), lo);
+        __m128i s = _mm_packs_epi32(_mm_cvttps_epi32(v0), _mm_cvttps_epi32(v1));
+
+        if (stereo)
+        {
+            __m128i l = _mm_and_si128(s, vleft);
+            __m128i r = _mm_and_si128(s, vright);
+            _mm_storeu_si128((__m128i *) (out + 2*n), _mm_unpacklo_epi16(l, r));
+            _mm_storeu_si128((__m128i *) (out + 2*n + 8), _mm_unpackhi_epi16(l, r));
+        }
+        else
+        {
+            _mm_storeu_si128((__m128i *) (out + n), s);
+        }
+    }
+
+    // tail with the gain ramp continued from n
+    audioOutScalar(in + n, stereo ? out + 2*n : out + n, nbSamples - n, gain + ((float) n * gainDelta), gainDelta, stereo, leftMask, rightMask);
+}
+
+#endif // DSD_SIMD_X86
+
+DSDMBEDecoder::DSDMBEDecoder(DSDDecoder *dsdDecoder, int slot) :
         m_dsdDecoder(dsdDecoder),
+        m_slot(slot),
         m_upsamplerLastValue(0.0f),
-        m_mbelibParms(0)
+        m_mbelibParms(0),
+        m_aoutMaxWindow(25),
+        m_audio_out_buf(0),
+        m_timestamp(0),
+        m_audioRate(0)
 {
+    m_absMax = absMaxScalar;
+    m_gainRamp = gainRampScalar;
+    m_audioOut = audioOutScalar;
+#ifdef DSD_SIMD_X86
+    if (DSDSimd::hasSSE2())
+    {
+        m_absMax = absMaxSSE2;
+        m_gainRamp = gainRampSSE2;
+        m_audioOut = audioOutSSE2;
+    }
+#endif
+
 #ifdef DSD_USE_MBELIB
     m_mbelibParms = new DSDmbelibParms();
 #endif
     m_audio_out_temp_buf_p = m_audio_out_temp_buf;
-    memset(m_audio_out_float_buf, 0, sizeof(float) * 1120);
+    memset(m_audio_out_float_buf, 0, sizeof(float) * 2 * 1120);
     m_audio_out_float_buf_p = m_audio_out_float_buf;
-    memset(m_aout_max_buf, 0, sizeof(float) * 200);
-    m_aout_max_buf_p = m_aout_max_buf;
-    m_aout_max_buf_idx = 0;
 
-    memset(m_audio_out_buf, 0, sizeof(short) * 2 * 48000);
     m_audio_out_buf_p = m_audio_out_buf;
     m_audio_out_nb_samples = 0;
     m_audio_out_buf_size = 48000; // given in number of unique samples
@@ -57,7 +199,7 @@ DSDMBEDecoder::DSDMBEDecoder(DSDDecoder *dsdDecoder) :
     m_channels = 3; // both channels by default if stereo is set
     m_upsample = 0;
 
-	initMbeParms();
+	initSynthesis();
 
 	memset(ambe_d, 0, 49);
 	memset(imbe_d, 0, 88);
@@ -68,9 +210,23 @@ DSDMBEDecoder::~DSDMBEDecoder()
 #ifdef DSD_USE_MBELIB
     delete m_mbelibParms;
 #endif
+    delete[] m_audio_out_buf;
 }
 
 void DSDMBEDecoder::initMbeParms()
+{
+    if (m_dsdDecoder->m_frameRecorder) {
+        m_dsdDecoder->m_frameRecorder->writeInit(m_slot, m_dsdDecoder->m_sampleCount);
+    }
+
+    if (m_dsdDecoder->m_vocoder) {
+        m_dsdDecoder->m_vocoder->postInit(m_slot);
+    } else {
+        initSynthesis();
+    }
+}
+
+void DSDMBEDecoder::initSynthesis()
 {
 #ifdef DSD_USE_MBELIB
 	mbe_initMbeParms(m_mbelibParms->m_cur_mp, m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced);
@@ -85,133 +241,178 @@ void DSDMBEDecoder::initMbeParms()
     }
 }
 
+bool DSDMBEDecoder::isAudioRateSupported(int audioRate)
+{
+    return (audioRate <= 0) || ((audioRate <= m_maxAudioRate) && DSDAudioResampler::isSupported(audioRate));
+}
+
+bool DSDMBEDecoder::setAudioRate(int audioRate)
+{
+    if (!isAudioRateSupported(audioRate)) {
+        return false;
+    }
+
+    m_audioRate = audioRate > 0 ? audioRate : 0;
+
+    if (m_audioRate)
+    {
+        m_audioResampler.setGain(m_volume);
+        m_audioResampler.setOutRate(m_audioRate, m_upsamplingFilter.usesHP());
+    }
+
+    return true;
+}
+
+void DSDMBEDecoder::useHP(bool useHP)
+{
+    m_upsamplingFilter.useHP(useHP);
+
+    if (m_audioRate) {
+        m_audioResampler.setOutRate(m_audioRate, useHP);
+    }
+}
+
 void DSDMBEDecoder::processFrame(char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24])
 {
+    if (m_dsdDecoder->m_frameRecorder)
+    {
+        m_dsdDecoder->recordCallInfo(m_slot);
+        m_dsdDecoder->m_frameRecorder->writeFrame(m_slot, m_dsdDecoder->m_sampleCount, m_dsdDecoder->m_mbeRate, m_dsdDecoder->m_opts.uvquality, imbe_fr, ambe_fr, imbe7100_fr);
+    }
+
+    if (!m_dsdDecoder->m_mbelibEnable) {
+        return;
+    }
+
+    if (m_dsdDecoder->m_vocoder)
+    {
+        m_dsdDecoder->m_vocoder->postFrame(m_slot, m_dsdDecoder->m_sampleCount, m_dsdDecoder->m_mbeRate, m_dsdDecoder->m_opts.uvquality, imbe_fr, ambe_fr, imbe7100_fr);
+        return;
+    }
+
+    m_timestamp = m_dsdDecoder->m_sampleCount;
+    synthesizeFrame(m_dsdDecoder->m_mbeRate, m_dsdDecoder->m_opts.uvquality, imbe_fr, ambe_fr, imbe7100_fr);
+
+    if (m_dsdDecoder->m_opts.errorbars == 1)
+    {
+        //m_dsdDecoder->getLogger().log("%s", m_err_str);
+        CString s(m_err_str);
+        //s.Format(L"%s", );
+        m_dsdDecoder->outputText(s);
+    }
+}
+
+void DSDMBEDecoder::processData(char imbe_data[88], char ambe_data[49])
+{
+    if (m_dsdDecoder->m_frameRecorder)
+    {
+        m_dsdDecoder->recordCallInfo(m_slot);
+        m_dsdDecoder->m_frameRecorder->writeData(m_slot, m_dsdDecoder->m_sampleCount, m_dsdDecoder->m_mbeRate, m_dsdDecoder->m_opts.uvquality, imbe_data, ambe_data);
+    }
+
     if (!m_dsdDecoder->m_mbelibEnable) {
         return;
     }
+
+    if (m_dsdDecoder->m_vocoder)
+    {
+        m_dsdDecoder->m_vocoder->postData(m_slot, m_dsdDecoder->m_sampleCount, m_dsdDecoder->m_mbeRate, m_dsdDecoder->m_opts.uvquality, imbe_data, ambe_data);
+        return;
+    }
+
+    m_timestamp = m_dsdDecoder->m_sampleCount;
+
+    if (synthesizeData(m_dsdDecoder->m_mbeRate, m_dsdDecoder->m_opts.uvquality, imbe_data, ambe_data)
+        && (m_dsdDecoder->m_opts.errorbars == 1))
+    {
+        m_dsdDecoder->getLogger().log("%s", m_err_str);
+    }
+}
+
+void DSDMBEDecoder::synthesizeFrame(int mbeRate, int uvquality, char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24])
+{
 #ifdef DSD_USE_MBELIB
     memset((void *) imbe_d, 0, 88);
 
-    if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate7200x4400)
+    if (mbeRate == DSDDecoder::DSDMBERate7200x4400)
     {
         mbe_processImbe7200x4400Framef(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, imbe_fr, imbe_d, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
-    else if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate7100x4400)
+    else if (mbeRate == DSDDecoder::DSDMBERate7100x4400)
     {
         mbe_processImbe7100x4400Framef(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, imbe7100_fr, imbe_d,
                 m_mbelibParms->m_cur_mp, m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced,
-                m_dsdDecoder->m_opts.uvquality);
+                uvquality);
     }
-    else if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate3600x2400)
+    else if (mbeRate == DSDDecoder::DSDMBERate3600x2400)
     {
         mbe_processAmbe3600x2400Framef(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, ambe_fr, ambe_d,m_mbelibParms-> m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
     else
     {
         mbe_processAmbe3600x2450Framef(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, ambe_fr, ambe_d, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
-    }
-
-    if (m_dsdDecoder->m_opts.errorbars == 1)
-    {
-        //m_dsdDecoder->getLogger().log("%s", m_err_str);
-        CString s(m_err_str);
-        //s.Format(L"%s", );
-        m_dsdDecoder->outputText(s);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
 
     processAudio();
 #endif
 }
 
-void DSDMBEDecoder::processData(char imbe_data[88], char ambe_data[49])
+bool DSDMBEDecoder::synthesizeData(int mbeRate, int uvquality, char imbe_data[88], char ambe_data[49])
 {
-    if (!m_dsdDecoder->m_mbelibEnable) {
-        return;
-    }
 #ifdef DSD_USE_MBELIB
-    if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate4400)
+    if (mbeRate == DSDDecoder::DSDMBERate4400)
     {
         mbe_processImbe4400Dataf(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, imbe_data, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
-    else if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate2400)
+    else if (mbeRate == DSDDecoder::DSDMBERate2400)
     {
         mbe_processAmbe2400Dataf(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, ambe_data, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
-    else if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate2450)
+    else if (mbeRate == DSDDecoder::DSDMBERate2450)
     {
         mbe_processAmbe2450Dataf(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, ambe_data, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
     else
     {
-        return;
-    }
-
-    if (m_dsdDecoder->m_opts.errorbars == 1)
-    {
-        m_dsdDecoder->getLogger().log("%s", m_err_str);
+        return false;
     }
 
     processAudio();
+    return true;
+#else
+    return false;
 #endif
 }
 
+/**
+ * Automatic gain over the last 25 frames, gain ramp, conversion to 16 bits and L+R interleaving. At 8 kS/s
+ * the ramp and output stages run in one pass of the output kernel. The other paths ramp the frame in place
+ * before the upsampler or resampler.
+ */
 void DSDMBEDecoder::processAudio()
 {
-    int i, n;
-    float aout_abs, max, gainfactor, gaindelta, maxbuf;
+    float gain = 1.0f;      // gain at the start of the frame
+    float gaindelta = 0.0f; // gain increment per sample
 
     if (m_auto_gain)
     {
-        // detect max level
-        max = 0;
-        m_audio_out_temp_buf_p = m_audio_out_temp_buf;
-
-        for (n = 0; n < 160; n++)
-        {
-            aout_abs = fabsf(*m_audio_out_temp_buf_p);
-
-            if (aout_abs > max)
-            {
-                max = aout_abs;
-            }
-
-            m_audio_out_temp_buf_p++;
-        }
-
-        *m_aout_max_buf_p = max;
-        m_aout_max_buf_p++;
-        m_aout_max_buf_idx++;
-
-        if (m_aout_max_buf_idx > 24)
-        {
-            m_aout_max_buf_idx = 0;
-            m_aout_max_buf_p = m_aout_max_buf;
-        }
-
-        // lookup max history
-        for (i = 0; i < 25; i++)
-        {
-            maxbuf = m_aout_max_buf[i];
-
-            if (maxbuf > max)
-            {
-                max = maxbuf;
-            }
-        }
+        // detect max level over this frame and the 24 previous ones
+        m_aoutMaxWindow.update(m_absMax(m_audio_out_temp_buf, 160));
+        float max = m_aoutMaxWindow.max_();
+        float gainfactor;
 
         // determine optimal gain level
         if (max > (float) 0)
@@ -244,29 +445,48 @@ void DSDMBEDecoder::processAudio()
         }
 
         gaindelta /= (float) 160;
+        gain = m_aout_gain;
+        m_aout_gain += ((float) 160 * gaindelta);
+    }
 
-        // adjust output gain
-        m_audio_out_temp_buf_p = m_audio_out_temp_buf;
-
-        for (n = 0; n < 160; n++)
-        {
-            *m_audio_out_temp_buf_p = (m_aout_gain
-                    + ((float) n * gaindelta)) * (*m_audio_out_temp_buf_p);
-            m_audio_out_temp_buf_p++;
-        }
+    // copy audio data to output buffer and upsample if necessary
+    m_audio_out_temp_buf_p = m_audio_out_temp_buf;
+    DSDAudioSink *audioSink = m_dsdDecoder->m_audioSink;
+    bool frameOutput = audioSink || m_dsdDecoder->m_vocoder; // polled buffer is owned by the caller's thread
 
-        m_aout_gain += ((float) 160 * gaindelta);
+    if (frameOutput)
+    {
+        m_audio_out_buf_p = m_audio_out_frame_buf;
+        m_audio_out_nb_samples = 0;
     }
-    else
+    else if (!m_audio_out_buf)
     {
-        gaindelta = (float) 0;
+        m_audio_out_buf = new short[2*48000];
+        m_audio_out_buf_p = m_audio_out_buf;
+        m_audio_out_nb_samples = 0;
     }
 
-    // copy audio data to output buffer and upsample if necessary
-    m_audio_out_temp_buf_p = m_audio_out_temp_buf;
+    bool floatOutput = audioSink && audioSink->floatFrames();
+    int nbFloatSamples = 0;
+    short leftMask = (m_channels & 1) ? -1 : 0;
+    short rightMask = ((m_channels>>1) & 1) ? -1 : 0;
+
+    if (m_audioRate)
+    {
+        if (m_audio_out_nb_samples + m_audioResampler.getMaxOutputs(160) >= m_audio_out_buf_size) {
+            resetAudio();
+        }
+
+        m_gainRamp(m_audio_out_temp_buf, 160, gain, gaindelta);
 
+        if (floatOutput) {
+            nbFloatSamples = resampleAudio(true);
+        } else {
+            m_audio_out_nb_samples += resampleAudio(false);
+        }
+    }
     //if ((m_upsample == 6) || (m_upsample == 7)) // upsampling to 48k
-    if (m_upsample >= 2)
+    else if (m_upsample >= 2)
     {
         int upsampling = m_upsample;
 
@@ -275,59 +495,22 @@ void DSDMBEDecoder::processAudio()
             resetAudio();
         }
 
+        m_gainRamp(m_audio_out_temp_buf, 160, gain, gaindelta);
         m_audio_out_float_buf_p = m_audio_out_float_buf;
 
-        for (n = 0; n < 160; n++)
+        for (int n = 0; n < 160; n++)
         {
             upsample(upsampling, *m_audio_out_temp_buf_p);
             m_audio_out_temp_buf_p++;
             m_audio_out_float_buf_p += upsampling;
-            m_audio_out_idx += upsampling;
-            m_audio_out_idx2 += upsampling;
         }
 
-        m_audio_out_float_buf_p = m_audio_out_float_buf;
-
-        // copy to output (short) buffer
-        for (n = 0; n < (160*upsampling); n++)
-        {
-            if (*m_audio_out_float_buf_p > (float) 32760)
-            {
-                *m_audio_out_float_buf_p = (float) 32760;
-            }
-            else if (*m_audio_out_float_buf_p < (float) -32760)
-            {
-                *m_audio_out_float_buf_p = (float) -32760;
-            }
-
-
-            if (m_stereo) // produce two channels
-            {
-            	if (m_channels & 1) { // left channel
-                    *m_audio_out_buf_p = (short) *m_audio_out_float_buf_p;
-            	} else {
-            		*m_audio_out_buf_p = 0;
-            	}
-
-                m_audio_out_buf_p++;
-
-                if ((m_channels>>1) & 1) { // right channel
-                    *m_audio_out_buf_p = (short) *m_audio_out_float_buf_p;
-            	} else {
-            		*m_audio_out_buf_p = 0;
-            	}
-
-                m_audio_out_buf_p++;
-            }
-            else // single (mono) channel
-            {
-                *m_audio_out_buf_p = (short) *m_audio_out_float_buf_p;
-                m_audio_out_buf_p++;
-            }
-
-            m_audio_out_nb_samples++;
-            m_audio_out_float_buf_p++;
-        }
+        // copy to output (short) buffer. In stereo only to the channels of the mask
+        m_audioOut(m_audio_out_float_buf, m_audio_out_buf_p, 160*upsampling, 1.0f, 0.0f, m_stereo, leftMask, rightMask);
+        m_audio_out_buf_p += (m_stereo ? 2 : 1) * 160*upsampling;
+        m_audio_out_nb_samples += 160*upsampling;
+        m_audio_out_idx += 160*upsampling;
+        m_audio_out_idx2 += 160*upsampling;
     }
     else // leave at 8k
     {
@@ -336,34 +519,80 @@ void DSDMBEDecoder::processAudio()
             resetAudio();
         }
 
-        m_audio_out_float_buf_p = m_audio_out_float_buf;
+        // gain ramp and copy to output (short) buffer. In stereo to both channels
+        m_audioOut(m_audio_out_temp_buf, m_audio_out_buf_p, 160, gain, gaindelta, m_stereo, -1, -1);
+        m_audio_out_buf_p += (m_stereo ? 2 : 1) * 160;
+        m_audio_out_nb_samples += 160;
+        m_audio_out_idx += 160;
+        m_audio_out_idx2 += 160;
+    }
+
+    if (frameOutput)
+    {
+        if (nbFloatSamples > 0) {
+            audioSink->audioFrameFloat(m_slot, m_audio_out_float_buf, nbFloatSamples, m_timestamp);
+        } else if (audioSink) {
+            audioSink->audioFrame(m_slot, m_audio_out_frame_buf, m_audio_out_nb_samples, m_timestamp);
+        }
+
+        m_audio_out_nb_samples = 0;
+        m_audio_out_buf_p = m_audio_out_buf;
+    }
+}
+
+/**
+ * Resamples the 160 samples frame with the polyphase resampler to the output (short) buffer or to the float
+ * buffer. In stereo the mono samples are written to the upper half of the destination first and spread
+ * to L+R pairs in place with the channel mask. Returns the number of (L+R) samples.
+ */
+int DSDMBEDecoder::resampleAudio(bool floatOutput)
+{
+    int nbSamples;
 
-        for (n = 0; n < 160; n++)
+    if (floatOutput)
+    {
+        float *mono = m_stereo ? &m_audio_out_float_buf[1120] : m_audio_out_float_buf;
+        nbSamples = m_audioResampler.run(m_audio_out_temp_buf, 160, mono);
+
+        if (m_stereo)
         {
-            if (*m_audio_out_temp_buf_p > (float) 32760)
-            {
-                *m_audio_out_temp_buf_p = (float) 32760;
-            }
-            else if (*m_audio_out_temp_buf_p < (float) -32760)
+            float left = (m_channels & 1) ? 1.0f : 0.0f;
+            float right = ((m_channels>>1) & 1) ? 1.0f : 0.0f;
+
+            for (int n = 0; n < nbSamples; n++)
             {
-                *m_audio_out_temp_buf_p = (float) -32760;
+                float v = mono[n];
+                m_audio_out_float_buf[2*n] = v * left;
+                m_audio_out_float_buf[2*n+1] = v * right;
             }
+        }
 
-            *m_audio_out_buf_p = (short) *m_audio_out_temp_buf_p;
-            m_audio_out_buf_p++;
+        return nbSamples;
+    }
 
-            if (m_stereo) // produce second channel
-            {
-                *m_audio_out_buf_p = (short) *m_audio_out_temp_buf_p;
-                m_audio_out_buf_p++;
-            }
+    if (m_stereo)
+    {
+        short *mono = m_audio_out_buf_p + m_audioResampler.getMaxOutputs(160);
+        nbSamples = m_audioResampler.run(m_audio_out_temp_buf, 160, mono);
+        short left = (m_channels & 1) ? -1 : 0;
+        short right = ((m_channels>>1) & 1) ? -1 : 0;
 
-            m_audio_out_nb_samples++;
-            m_audio_out_temp_buf_p++;
-            m_audio_out_idx++;
-            m_audio_out_idx2++;
+        for (int n = 0; n < nbSamples; n++)
+        {
+            short v = mono[n];
+            m_audio_out_buf_p[2*n] = v & left;
+            m_audio_out_buf_p[2*n+1] = v & right;
         }
+
+        m_audio_out_buf_p += 2*nbSamples;
+    }
+    else
+    {
+        nbSamples = m_audioResampler.run(m_audio_out_temp_buf, 160, m_audio_out_buf_p);
+        m_audio_out_buf_p += nbSamples;
     }
+
+    return nbSamples;
 }
 
 void DSDMBEDecoder::upsample(int upsampling, float invalue)
@@ -17,7 +17,11 @@
 #ifndef DSDCC_DSD_MBE_H_
 #define DSDCC_DSD_MBE_H_
 
+#include <stdint.h>
+
 #include "dsd_filters.h"
+#include "dsd_audioresampler.h"
+#include "runningmaxmin.h"
 #include "export.h"
 
 namespace DSDcc
@@ -28,15 +32,21 @@ struct DSDmbelibParms;
 
 class DSDCC_API DSDMBEDecoder
 {
+    friend class DSDVocoder;
+    friend class DSDDecoder;
 public:
-    explicit DSDMBEDecoder(DSDDecoder *dsdDecoder);
+    DSDMBEDecoder(DSDDecoder *dsdDecoder, int slot);
     ~DSDMBEDecoder();
 
+    /**
+     * The three following are posted to the vocoder thread when it is on (see DSDDecoder::setVocoderThread).
+     * They are recorded first when a frame recorder is set (see DSDDecoder::setFrameRecorder)
+     */
     void initMbeParms();
     void processFrame(char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24]);
     void processData(char imbe_data[88], char ambe_data[49]);
 
-    short *getAudio(int& nbSamples)
+    short *getAudio(int& nbSamples) //!< polled output. The buffer is allocated at the first frame synthesized without audio sink
     {
         nbSamples = m_audio_out_nb_samples;
         return m_audio_out_buf;
@@ -50,18 +60,38 @@ public:
 
     void setAudioGain(float aout_gain) { m_aout_gain = aout_gain; }
     void setAutoGain(bool auto_gain) { m_auto_gain = auto_gain; }
-    void setVolume(float volume) { m_volume = volume; }
+    void setVolume(float volume)
+    {
+        m_volume = volume;
+        m_audioResampler.setGain(volume);
+    }
+
     void setStereo(bool stereo) { m_stereo = stereo; }
     void setChannels(unsigned char channels) { m_channels = channels % 4; }
     void setUpsamplingFactor(int upsample) { m_upsample = upsample; }
     int getUpsamplingFactor() const { return m_upsample; }
-    void useHP(bool useHP) { m_upsamplingFilter.useHP(useHP); }
+    bool setAudioRate(int audioRate); //!< 0 for 8 kS/s times the upsampling factor else a rate through the polyphase resampler. Unsupported rates are rejected (see isAudioRateSupported)
+    int getAudioRate() const { return m_audioRate; }
+    void useHP(bool useHP);
+
+    static bool isAudioRateSupported(int audioRate); //!< true for 0 and for the rates up to m_maxAudioRate the resampler can do
+    static const int m_maxAudioRate = 56000; //!< a 160 samples frame at this rate fills the 1120 samples per channel of the frame buffers
 
 private:
+    typedef float (*AbsMaxKernel)(const float *in, int nbSamples);
+    typedef void (*GainRampKernel)(float *buf, int nbSamples, float gain, float gainDelta);
+    /** gain ramp, clip, conversion to 16 bits and in stereo L+R interleaving with the channel masks */
+    typedef void (*AudioOutKernel)(const float *in, short *out, int nbSamples, float gain, float gainDelta, bool stereo, short leftMask, short rightMask);
+
+    void initSynthesis();
+    void synthesizeFrame(int mbeRate, int uvquality, char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24]);
+    bool synthesizeData(int mbeRate, int uvquality, char imbe_data[88], char ambe_data[49]);
     void processAudio();
+    int resampleAudio(bool floatOutput);
     void upsample(int upsampling, float invalue);
 
     DSDDecoder *m_dsdDecoder;
+    int m_slot;                //!< 0 for TDMA unique or first slot, 1 for second slot
     char imbe_d[88];
     char ambe_d[49];
     float m_upsamplerLastValue;
@@ -74,19 +104,19 @@ private:
     float m_audio_out_temp_buf[160];   //!< output of decoder
     float *m_audio_out_temp_buf_p;
 
-    float m_audio_out_float_buf[1120]; //!< output of upsampler - 1 frame of 160 samples upampled up to 7 times
+    float m_audio_out_float_buf[2*1120]; //!< output of upsampler - 1 frame of 160 samples upampled up to 7 times. L+R for float audio sinks
     float *m_audio_out_float_buf_p;
 
-    float m_aout_max_buf[200];
-    float *m_aout_max_buf_p;
-    int m_aout_max_buf_idx;
+    lemiremaxmintruestreaming<float> m_aoutMaxWindow; //!< max level of the last 25 frames
 
-    short m_audio_out_buf[2*48000];    //!< final result - 1s of L+R S16LE samples
+    short *m_audio_out_buf;            //!< final result - 1s of L+R S16LE samples. Polled output only
+    short m_audio_out_frame_buf[2*1120]; //!< final result - 1 frame of L+R S16LE samples for the audio sink
     short *m_audio_out_buf_p;
     int   m_audio_out_nb_samples;
     int   m_audio_out_buf_size;
     int   m_audio_out_idx;
     int   m_audio_out_idx2;
+    uint64_t m_timestamp;              //!< decoder sample count when the frame being synthesized was extracted
 
     float m_aout_gain;
     float m_volume;
@@ -96,6 +126,11 @@ private:
     unsigned char m_channels;  //!< when in stereo output to none (0) or only left (1), right (2) or both (3) channels
 
     DSDMBEAudioInterpolatorFilter m_upsamplingFilter;
+    AbsMaxKernel m_absMax;
+    GainRampKernel m_gainRamp;
+    AudioOutKernel m_audioOut;
+    int m_audioRate;                   //!< 0 or output rate of m_audioResampler
+    DSDAudioResampler m_audioResampler;
 };
 
 }
@@ -0,0 +1,630 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <algorithm>
+#include <thread>
+
+#include "dsd_pool.h"
+
+namespace DSDcc
+{
+
+struct DSDDecoderPool::Job
+{
+    Job() : samples(0), iqSamples(0), nbSamples(0), next(0) {}
+    ~Job() { delete[] samples; delete[] iqSamples; }
+
+    short *samples;
+    std::complex<float> *iqSamples;
+    unsigned int nbSamples;
+    std::atomic<Job*> next;
+};
+
+/**
+ * Intrusive multiple producer single consumer queue (D. Vyukov). Producers never wait. The consumer
+ * may see an empty queue while a push is in progress.
+ */
+class DSDDecoderPool::JobQueue
+{
+public:
+    JobQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    void push(Job *job)
+    {
+        job->next.store(0, std::memory_order_relaxed);
+        Job *prev = m_head.exchange(job, std::memory_order_acq_rel);
+        prev->next.store(job, std::memory_order_release);
+    }
+
+    Job *pop()
+    {
+        Job *tail = m_tail;
+        Job *next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &m_stub)
+        {
+            if (!next) {
+                return 0;
+            }
+
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            m_tail = next;
+            return tail;
+        }
+
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return 0; // a push is in progress
+        }
+
+        push(&m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+
+        if (next)
+        {
+            m_tail = next;
+            return tail;
+        }
+
+        return 0;
+    }
+
+private:
+    std::atomic<Job*> m_head;
+    Job *m_tail;
+    Job m_stub;
+};
+
+/**
+ * Fixed size work stealing deque (Chase and Lev) with sequentially consistent top and bottom. The owner
+ * pushes and pops at the bottom, thieves steal at the top. A channel is in at most one queue at a
+ * time so a capacity of the number of channels is never exceeded.
+ */
+class DSDDecoderPool::TaskDeque
+{
+public:
+    explicit TaskDeque(int capacity) :
+        m_top(0),
+        m_bottom(0),
+        m_mask(capacity - 1)
+    {
+        m_tasks = new std::atomic<int>[capacity];
+    }
+
+    ~TaskDeque()
+    {
+        delete[] m_tasks;
+    }
+
+    void push(int task)
+    {
+        long b = m_bottom.load(std::memory_order_relaxed);
+        m_tasks[b & m_mask].store(task, std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    int pop()
+    {
+        long b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_seq_cst);
+        long t = m_top.load(std::memory_order_seq_cst);
+
+        if (t > b)
+        {
+            m_bottom.store(b + 1, std::memory_order_release);
+            return -1;
+        }
+
+        int task = m_tasks[b & m_mask].load(std::memory_order_relaxed);
+
+        if (t == b) // last one: race against thieves
+        {
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = -1;
+            }
+
+            m_bottom.store(b + 1, std::memory_order_release);
+        }
+
+        return task;
+    }
+
+    int steal()
+    {
+        long t = m_top.load(std::memory_order_seq_cst);
+        long b = m_bottom.load(std::memory_order_seq_cst);
+
+        if (t >= b) {
+            return -1;
+        }
+
+        int task = m_tasks[t & m_mask].load(std::memory_order_relaxed);
+
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return -1; // lost the race
+        }
+
+        return task;
+    }
+
+private:
+    std::atomic<long> m_top;
+    char m_pad[64 - sizeof(std::atomic<long>)]; //!< keep thieves and owner on separate cache lines
+    std::atomic<long> m_bottom;
+    std::atomic<int> *m_tasks;
+    long m_mask;
+};
+
+/**
+ * Bounded multiple producer multiple consumer queue (D. Vyukov) where the channel tasks posted from
+ * the submitting threads wait for a worker.
+ */
+class DSDDecoderPool::TaskQueue
+{
+public:
+    explicit TaskQueue(int capacity) :
+        m_mask(capacity - 1),
+        m_enqueuePos(0),
+        m_dequeuePos(0)
+    {
+        m_cells = new Cell[capacity];
+
+        for (int i = 0; i < capacity; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~TaskQueue()
+    {
+        delete[] m_cells;
+    }
+
+    bool enqueue(int task)
+    {
+        Cell *cell;
+        unsigned long pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            long diff = (long) cell->sequence.load(std::memory_order_acquire) - (long) pos;
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->task = task;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    int dequeue()
+    {
+        Cell *cell;
+        unsigned long pos = m_dequeuePos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            long diff = (long) cell->sequence.load(std::memory_order_acquire) - (long) (pos + 1);
+
+            if (diff == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return -1; // empty
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        int task = cell->task;
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return task;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<unsigned long> sequence;
+        int task;
+    };
+
+    Cell *m_cells;
+    unsigned long m_mask;
+    std::atomic<unsigned long> m_enqueuePos;
+    char m_pad[64 - sizeof(std::atomic<unsigned long>)];
+    std::atomic<unsigned long> m_dequeuePos;
+};
+
+/**
+ * Forwards the audio frames of a channel's decoder to the pool audio callback
+ */
+class DSDDecoderPool::ChannelSink : public DSDAudioSink
+{
+public:
+    ChannelSink() : m_pool(0), m_channel(0) {}
+
+    void init(DSDDecoderPool *pool, int channel)
+    {
+        m_pool = pool;
+        m_channel = channel;
+    }
+
+    virtual void audioFrame(int slot, const short *samples, int nbSamples, uint64_t)
+    {
+        if (m_pool->m_audioCallback) {
+            m_pool->m_audioCallback(m_channel, slot, samples, nbSamples, m_pool->m_audioContext);
+        }
+    }
+
+private:
+    DSDDecoderPool *m_pool;
+    int m_channel;
+};
+
+struct DSDDecoderPool::Channel
+{
+    Channel() : decoder(0), pending(0) {}
+
+    DSDDecoder *decoder;
+    ChannelSink sink;
+    JobQueue jobs;
+    std::atomic<int> pending; //!< blocks not yet decoded. The channel task is posted when it leaves 0 and ends when it gets back to 0
+};
+
+struct DSDDecoderPool::Worker
+{
+    Worker() : deque(0), random(0) {}
+
+    std::thread thread;
+    TaskDeque *deque;
+    unsigned int random; //!< xorshift state to pick the first victim
+};
+
+DSDDecoderPool::DSDDecoderPool(int nbChannels, int nbThreads) :
+        m_nbChannels(nbChannels),
+        m_pendingJobs(0),
+        m_epoch(0),
+        m_sleepers(0),
+        m_stop(false),
+        m_audioCallback(0),
+        m_audioContext(0),
+        m_dvFrameCallback(0),
+        m_dvFrameContext(0)
+{
+    assert(nbChannels > 0);
+
+    if (nbThreads <= 0) {
+        nbThreads = std::thread::hardware_concurrency();
+    }
+
+    m_nbWorkers = nbThreads < 1 ? 1 : nbThreads;
+
+    int capacity = 1;
+
+    while (capacity < m_nbChannels) {
+        capacity <<= 1;
+    }
+
+    m_channels = new Channel[m_nbChannels]; // decoders are created on first use (see getDecoder)
+
+    for (int i = 0; i < m_nbChannels; i++) {
+        m_channels[i].sink.init(this, i);
+    }
+
+    m_sharedQueue = new TaskQueue(capacity);
+    m_workers = new Worker[m_nbWorkers];
+
+    for (int i = 0; i < m_nbWorkers; i++)
+    {
+        m_workers[i].deque = new TaskDeque(capacity);
+        m_workers[i].random = 2463534242U + i;
+    }
+
+    for (int i = 0; i < m_nbWorkers; i++) {
+        m_workers[i].thread = std::thread(workerLoop, this, i);
+    }
+}
+
+DSDDecoderPool::~DSDDecoderPool()
+{
+    flush();
+    m_stop.store(true);
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_sleepCond.notify_all();
+    }
+
+    for (int i = 0; i < m_nbWorkers; i++) {
+        m_workers[i].thread.join();
+    }
+
+    for (int i = 0; i < m_nbWorkers; i++) {
+        delete m_workers[i].deque;
+    }
+
+    delete[] m_workers;
+    delete m_sharedQueue;
+
+    for (int i = 0; i < m_nbChannels; i++) {
+        delete m_channels[i].decoder;
+    }
+
+    delete[] m_channels;
+}
+
+DSDDecoder *DSDDecoderPool::getDecoder(int channel)
+{
+    assert((channel >= 0) && (channel < m_nbChannels));
+    Channel& ch = m_channels[channel];
+
+    if (!ch.decoder)
+    {
+        ch.decoder = new DSDDecoder();
+        ch.decoder->setAudioSink(&ch.sink);
+    }
+
+    return ch.decoder;
+}
+
+void DSDDecoderPool::setAudioCallback(AudioCallback callback, void *context)
+{
+    m_audioCallback = callback;
+    m_audioContext = context;
+}
+
+void DSDDecoderPool::setDVFrameCallback(DVFrameCallback callback, void *context)
+{
+    m_dvFrameCallback = callback;
+    m_dvFrameContext = context;
+}
+
+void DSDDecoderPool::submit(int channel, const short *samples, unsigned int nbSamples)
+{
+    assert((channel >= 0) && (channel < m_nbChannels));
+    Job *job = new Job();
+    job->samples = new short[nbSamples];
+    job->nbSamples = nbSamples;
+    std::copy(samples, samples + nbSamples, job->samples);
+    post(channel, job);
+}
+
+void DSDDecoderPool::submitIQ(int channel, const std::complex<float> *samples, unsigned int nbSamples)
+{
+    assert((channel >= 0) && (channel < m_nbChannels));
+    Job *job = new Job();
+    job->iqSamples = new std::complex<float>[nbSamples];
+    job->nbSamples = nbSamples;
+    std::copy(samples, samples + nbSamples, job->iqSamples);
+    post(channel, job);
+}
+
+void DSDDecoderPool::flush()
+{
+    std::unique_lock<std::mutex> lock(m_flushMutex);
+
+    while (m_pendingJobs.load() > 0) {
+        m_flushCond.wait(lock);
+    }
+}
+
+void DSDDecoderPool::post(int channel, Job *job)
+{
+    Channel& ch = m_channels[channel];
+    getDecoder(channel); // the worker picking the job up sees it through the job queue
+    m_pendingJobs.fetch_add(1);
+    ch.jobs.push(job);
+
+    if (ch.pending.fetch_add(1) == 0) // the channel was idle: no worker owns it
+    {
+        bool queued = m_sharedQueue->enqueue(channel);
+        assert(queued);
+        (void) queued;
+        signal();
+    }
+}
+
+/**
+ * Wakes up one sleeping worker if any. A worker registers as a sleeper before reading the epoch
+ * and looking for a task a last time so either it finds the posted task or it sees the epoch change.
+ */
+void DSDDecoderPool::signal()
+{
+    m_epoch.fetch_add(1);
+
+    if (m_sleepers.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_sleepCond.notify_one();
+    }
+}
+
+int DSDDecoderPool::findTask(int worker)
+{
+    Worker& w = m_workers[worker];
+    int task = w.deque->pop();
+
+    if (task >= 0) {
+        return task;
+    }
+
+    task = m_sharedQueue->dequeue();
+
+    if (task >= 0) {
+        return task;
+    }
+
+    if (m_nbWorkers > 1)
+    {
+        w.random ^= w.random << 13;
+        w.random ^= w.random >> 17;
+        w.random ^= w.random << 5;
+        int victim = w.random % m_nbWorkers;
+
+        for (int i = 0; i < m_nbWorkers; i++, victim = (victim + 1) % m_nbWorkers)
+        {
+            if (victim == worker) {
+                continue;
+            }
+
+            task = m_workers[victim].deque->steal();
+
+            if (task >= 0) {
+                return task;
+            }
+        }
+    }
+
+    return -1;
+}
+
+void DSDDecoderPool::runTask(int worker, int channel)
+{
+    Channel& ch = m_channels[channel];
+
+    for (int i = 0; i < m_jobsPerTurn; i++)
+    {
+        Job *job;
+
+        while ((job = ch.jobs.pop()) == 0) { // counted but still being pushed
+            std::this_thread::yield();
+        }
+
+        decode(channel, job);
+        delete job;
+
+        if (m_pendingJobs.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(m_flushMutex);
+            m_flushCond.notify_all();
+        }
+
+        if (ch.pending.fetch_sub(1) == 1) { // nothing left: the next submission posts the channel again
+            return;
+        }
+    }
+
+    // give other channels a turn. Another worker may steal this one meanwhile
+    m_workers[worker].deque->push(channel);
+    signal();
+}
+
+void DSDDecoderPool::workerLoop(DSDDecoderPool *pool, int worker)
+{
+    while (true)
+    {
+        int task = pool->findTask(worker);
+
+        if (task >= 0)
+        {
+            pool->runTask(worker, task);
+            continue;
+        }
+
+        pool->m_sleepers.fetch_add(1);
+        unsigned int epoch = pool->m_epoch.load();
+        task = pool->findTask(worker);
+
+        if (task >= 0)
+        {
+            pool->m_sleepers.fetch_sub(1);
+            pool->runTask(worker, task);
+            continue;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(pool->m_sleepMutex);
+
+            while (!pool->m_stop.load() && (pool->m_epoch.load() == epoch)) {
+                pool->m_sleepCond.wait(lock);
+            }
+        }
+
+        pool->m_sleepers.fetch_sub(1);
+
+        if (pool->m_stop.load()) { // the destructor flushed so no task can be left
+            return;
+        }
+    }
+}
+
+/**
+ * Blocks are fed in chunks of about 32 symbols at 9600 baud so that at most one DV frame per slot
+ * completes between polls of the decoder.
+ */
+void DSDDecoderPool::decode(int channel, const Job *job)
+{
+    DSDDecoder *decoder = m_channels[channel].decoder;
+    unsigned int chunkSize = (32 * decoder->getInputRate()) / 9600;
+    chunkSize = chunkSize < 1 ? 1 : chunkSize;
+
+    for (unsigned int i = 0; i < job->nbSamples; i += chunkSize)
+    {
+        unsigned int n = job->nbSamples - i < chunkSize ? job->nbSamples - i : chunkSize;
+
+        if (job->iqSamples) {
+            decoder->runIQ(&job->iqSamples[i], n);
+        } else {
+            decoder->run(&job->samples[i], n);
+        }
+
+        if (decoder->mbeDVReady1())
+        {
+            if (m_dvFrameCallback) {
+                m_dvFrameCallback(channel, 0, decoder->getMbeDVFrame1(), decoder->getMbeRate(), m_dvFrameContext);
+            }
+
+            decoder->resetMbeDV1();
+        }
+
+        if (decoder->mbeDVReady2())
+        {
+            if (m_dvFrameCallback) {
+                m_dvFrameCallback(channel, 1, decoder->getMbeDVFrame2(), decoder->getMbeRate(), m_dvFrameContext);
+            }
+
+            decoder->resetMbeDV2();
+        }
+    }
+}
+
+} // namespace DSDcc
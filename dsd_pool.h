@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_POOL_H_
+#define DSDCC_DSD_POOL_H_
+
+#include <complex>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "dsd_decoder.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Owns one DSDDecoder per channel and decodes the sample blocks submitted for each channel on a pool
+ * of worker threads.
+ *
+ * A channel with pending blocks is a task that is run by one worker at a time so the blocks of a
+ * channel are always decoded in submission order. Each worker has a lock free work stealing deque
+ * of channel tasks. Tasks of channels becoming busy are posted to a lock free shared queue. A worker
+ * takes tasks from its own deque first, then from the shared queue, then steals from the other
+ * workers. A channel yields its worker after a few blocks and is pushed back on that worker's
+ * deque so that busy channels are spread over idle workers.
+ *
+ * Audio and DV frames are delivered through callbacks invoked from the worker threads. Audio is pushed by
+ * the decoders to a per channel audio sink as each frame is synthesized so decoders are not polled for it.
+ * Blocks of one channel must be submitted from one thread at a time. Decoders of channels that are
+ * never used are not created.
+ */
+class DSDCC_API DSDDecoderPool
+{
+public:
+    typedef void (*AudioCallback)(int channel, int slot, const short *samples, int nbSamples, void *context); //!< slot is 0 or 1
+    typedef void (*DVFrameCallback)(int channel, int slot, const unsigned char *frame, DSDDecoder::DSDMBERate rate, void *context);
+
+    DSDDecoderPool(int nbChannels, int nbThreads); //!< nbThreads 0 for one per hardware thread
+    ~DSDDecoderPool(); //!< decodes pending blocks before returning
+
+    DSDDecoder *getDecoder(int channel); //!< created on first call or first submission. Change settings only when the channel has no pending block (see flush)
+    void setAudioCallback(AudioCallback callback, void *context);   //!< set before submitting: workers read it without synchronization
+    void setDVFrameCallback(DVFrameCallback callback, void *context); //!< set before submitting: workers read it without synchronization
+
+    int getNbChannels() const { return m_nbChannels; }
+    int getNbThreads() const { return m_nbWorkers; }
+
+    void submit(int channel, const short *samples, unsigned int nbSamples); //!< discriminator output (see DSDDecoder::run). Samples are copied
+    void submitIQ(int channel, const std::complex<float> *samples, unsigned int nbSamples); //!< complex baseband (see DSDDecoder::runIQ). Samples are copied
+    void flush(); //!< returns when all blocks submitted so far have been decoded
+
+private:
+    struct Job;
+    class ChannelSink;
+    struct Channel;
+    class JobQueue;
+    class TaskDeque;
+    class TaskQueue;
+    struct Worker;
+
+    void post(int channel, Job *job);
+    void signal();
+    int findTask(int worker);
+    void runTask(int worker, int channel);
+    void decode(int channel, const Job *job);
+    static void workerLoop(DSDDecoderPool *pool, int worker);
+
+    int m_nbChannels;
+    int m_nbWorkers;
+    Channel *m_channels;
+    Worker *m_workers;
+    TaskQueue *m_sharedQueue;
+
+    std::atomic<int> m_pendingJobs;   //!< submitted and not yet decoded blocks
+    std::mutex m_flushMutex;
+    std::condition_variable m_flushCond;
+
+    std::atomic<unsigned int> m_epoch; //!< bumped each time a task is posted
+    std::atomic<int> m_sleepers;      //!< workers about to wait or waiting for a task
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCond;
+    std::atomic<bool> m_stop;
+
+    AudioCallback m_audioCallback;
+    void *m_audioContext;
+    DVFrameCallback m_dvFrameCallback;
+    void *m_dvFrameContext;
+
+    static const int m_jobsPerTurn = 4; //!< blocks a channel decodes before yielding its worker
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_POOL_H_ */
@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "dsd_rateprobe.h"
+
+namespace DSDcc
+{
+
+const DSDSync::SyncPattern DSDRateProbe::m_patterns2400[] = {
+    DSDSync::SyncNXDNRDCHFull,
+    DSDSync::SyncNXDNRDCHFullInv,
+    DSDSync::SyncDPMRFS1
+};
+
+const DSDSync::SyncPattern DSDRateProbe::m_patterns4800[] = {
+    DSDSync::SyncDMRDataBS,
+    DSDSync::SyncDMRVoiceBS,
+    DSDSync::SyncDMRDataMS,
+    DSDSync::SyncDMRVoiceMS,
+    DSDSync::SyncDStarHeader,
+    DSDSync::SyncDStarHeaderInv,
+    DSDSync::SyncDStar,
+    DSDSync::SyncDStarInv,
+    DSDSync::SyncYSF,
+    DSDSync::SyncP25P1,
+    DSDSync::SyncP25P1Inv,
+    DSDSync::SyncX2TDMADataBS,
+    DSDSync::SyncX2TDMAVoiceBS,
+    DSDSync::SyncX2TDMADataMS,
+    DSDSync::SyncX2TDMAVoiceMS,
+    DSDSync::SyncNXDNRDCHFull,
+    DSDSync::SyncNXDNRDCHFullInv
+};
+
+const DSDSync::SyncPattern DSDRateProbe::m_patterns9600[] = {
+    DSDSync::SyncProVoice,
+    DSDSync::SyncProVoiceInv,
+    DSDSync::SyncProVoiceEA,
+    DSDSync::SyncProVoiceEAInv
+};
+
+DSDRateProbe::DSDRateProbe(DSDDecoder *dsdDecoder) :
+        m_symbol(dsdDecoder),
+        m_history(0),
+        m_historySize(0),
+        m_historyIndex(0),
+        m_historyCount(0),
+        m_baudRate(4800),
+        m_nbSymbols(0),
+        m_patterns(m_patterns4800),
+        m_nbPatterns(sizeof(m_patterns4800) / sizeof(DSDSync::SyncPattern))
+{
+}
+
+DSDRateProbe::~DSDRateProbe()
+{
+    delete[] m_history;
+}
+
+/**
+ * The chain rate follows DSDDecoder::configureSymbolChain at the probe symbol rate
+ */
+void DSDRateProbe::configure(int baudRate, int inputRate, int inRate, DSDSymbol::TimingRecovery timingRecovery)
+{
+    int chainRate = DSDSymbol::getChainRate(inputRate, baudRate, timingRecovery);
+
+    if (baudRate == 2400)
+    {
+        m_patterns = m_patterns2400;
+        m_nbPatterns = sizeof(m_patterns2400) / sizeof(DSDSync::SyncPattern);
+    }
+    else if (baudRate == 9600)
+    {
+        m_patterns = m_patterns9600;
+        m_nbPatterns = sizeof(m_patterns9600) / sizeof(DSDSync::SyncPattern);
+    }
+    else
+    {
+        baudRate = 4800;
+        m_patterns = m_patterns4800;
+        m_nbPatterns = sizeof(m_patterns4800) / sizeof(DSDSync::SyncPattern);
+    }
+
+    int historySize = (m_historySymbols * chainRate) / baudRate;
+
+    if (historySize > m_maxHistory) {
+        historySize = m_maxHistory;
+    }
+
+    if (historySize != m_historySize)
+    {
+        delete[] m_history;
+        m_history = new short[historySize];
+        m_historySize = historySize;
+    }
+
+    m_baudRate = baudRate;
+    m_resampler.setRates(inRate, chainRate);
+    m_symbol.setTimingRecovery(timingRecovery);
+    m_symbol.setSampleRate(chainRate);
+    m_symbol.setSamplesPerSymbol(48000 / baudRate);
+    reset();
+}
+
+void DSDRateProbe::reset()
+{
+    m_resampler.reset();
+    m_symbol.noCarrier();
+    m_nbSymbols = 0;
+    m_historyIndex = 0;
+    m_historyCount = 0;
+}
+
+bool DSDRateProbe::run(short sample)
+{
+    if (m_resampler.isPassThrough()) {
+        return pushSample(sample);
+    }
+
+    int nbResampled = m_resampler.run(sample, m_resampled);
+    bool syncFound = false;
+
+    for (int i = 0; i < nbResampled; i++) {
+        syncFound = pushSample(m_resampled[i]) || syncFound;
+    }
+
+    return syncFound;
+}
+
+int DSDRateProbe::copyHistory(short *samples) const
+{
+    int start = m_historyIndex - m_historyCount;
+
+    if (start < 0) {
+        start += m_historySize;
+    }
+
+    for (int i = 0; i < m_historyCount; i++) {
+        samples[i] = m_history[(start + i) % m_historySize];
+    }
+
+    return m_historyCount;
+}
+
+bool DSDRateProbe::pushSample(short sample)
+{
+    m_history[m_historyIndex] = sample;
+    m_historyIndex = (m_historyIndex + 1 == m_historySize) ? 0 : m_historyIndex + 1;
+
+    if (m_historyCount < m_historySize) {
+        m_historyCount++;
+    }
+
+    if (!m_symbol.pushSample(sample)) {
+        return false;
+    }
+
+    if (m_nbSymbols < 18)
+    {
+        m_nbSymbols++;
+        return false;
+    }
+
+    DSDSync syncEngine;
+    syncEngine.matchSome(m_symbol.getSyncHistory(), DSDSync::m_history, m_patterns, m_nbPatterns);
+
+    for (int i = 0; i < m_nbPatterns; i++)
+    {
+        if (syncEngine.isMatching(m_patterns[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace DSDcc
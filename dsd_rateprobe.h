@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_RATEPROBE_H_
+#define DSDCC_DSD_RATEPROBE_H_
+
+#include "dsd_symbol.h"
+#include "dsd_resampler.h"
+#include "dsd_sync.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+class DSDDecoder;
+
+/**
+ * Sync search at one symbol rate for the auto rate detection of DSDDecoder. This is a symbol
+ * recovery chain followed by a match of the long sync patterns of the protocols at that rate
+ * and nothing else. Short patterns (NXDN FSW, dPMR FS2 and FS3) are left out as they match noise
+ * too often.
+ *
+ * It takes the samples of the decoder symbol chain and runs at the chain rate the decoder would
+ * use at the probe symbol rate, resampling only when the two differ. The last samples at that rate
+ * are kept so that the decoder can replay them once it has moved to the probe symbol rate.
+ */
+class DSDCC_API DSDRateProbe
+{
+public:
+    explicit DSDRateProbe(DSDDecoder *dsdDecoder);
+    ~DSDRateProbe();
+
+    void configure(int baudRate, int inputRate, int inRate, DSDSymbol::TimingRecovery timingRecovery); //!< inputRate is the decoder input rate and inRate its symbol chain rate
+    void reset();
+    bool run(short sample); //!< push one decoder symbol chain sample. Returns true if a sync pattern has been found
+    int getBaudRate() const { return m_baudRate; }
+    int copyHistory(short *samples) const; //!< oldest first. samples must hold m_maxHistory samples. Returns the number of samples copied
+
+    static const int m_historySymbols = 64; //!< symbols of history kept for the replay
+    static const int m_maxHistory = 2048;   //!< history limit in samples
+
+private:
+    bool pushSample(short sample);
+
+    DSDSymbol m_symbol;
+    DSDResampler m_resampler;
+    short m_resampled[8];
+    short *m_history;                     //!< ring buffer of the last probe chain samples
+    int m_historySize;
+    int m_historyIndex;                   //!< next write index
+    int m_historyCount;
+    int m_baudRate;
+    int m_nbSymbols;                      //!< symbols since reset. Search starts after 18 like DSDDecoder::getFrameSync
+    const DSDSync::SyncPattern *m_patterns;
+    int m_nbPatterns;
+
+    static const DSDSync::SyncPattern m_patterns2400[];
+    static const DSDSync::SyncPattern m_patterns4800[];
+    static const DSDSync::SyncPattern m_patterns9600[];
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_RATEPROBE_H_ */
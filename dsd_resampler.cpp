@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#include "dsd_resampler.h"
+
+namespace DSDcc
+{
+
+static int gcd(int a, int b)
+{
+    while (b != 0)
+    {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+DSDResampler::DSDResampler() :
+        m_inRate(48000),
+        m_outRate(48000),
+        m_interp(1),
+        m_decim(1),
+        m_tapsPerPhase(0),
+        m_paddedTaps(0),
+        m_coeffs(0),
+        m_history(0),
+        m_index(0),
+        m_phase(0)
+{
+    m_dot = DSDFIRFilter::selectKernel();
+}
+
+DSDResampler::~DSDResampler()
+{
+    if (m_coeffs) {
+        delete[] m_coeffs;
+    }
+
+    if (m_history) {
+        delete[] m_history;
+    }
+}
+
+bool DSDResampler::isSupported(int inRate, int outRate)
+{
+    return (inRate > 0) && (outRate > 0) && (outRate / gcd(inRate, outRate) <= m_maxInterp);
+}
+
+void DSDResampler::setRates(int inRate, int outRate, int tapsPerPhase)
+{
+    assert(isSupported(inRate, outRate) && (tapsPerPhase > 0));
+
+    if ((inRate == m_inRate) && (outRate == m_outRate) && (isPassThrough() || (tapsPerPhase == m_tapsPerPhase))) {
+        return; // keep the history so that reconfiguring the chain does not make a transient
+    }
+
+    int d = gcd(inRate, outRate);
+    m_inRate = inRate;
+    m_outRate = outRate;
+    m_interp = outRate / d;
+    m_decim = inRate / d;
+
+    if (m_coeffs) {
+        delete[] m_coeffs;
+    }
+
+    if (m_history) {
+        delete[] m_history;
+    }
+
+    m_coeffs = 0;
+    m_history = 0;
+
+    if (isPassThrough()) {
+        return;
+    }
+
+    m_tapsPerPhase = tapsPerPhase;
+    m_paddedTaps = (tapsPerPhase + 7) & ~7;
+    m_coeffs = new float[m_interp * m_paddedTaps];
+    m_history = new float[2*m_tapsPerPhase + 8];
+    memset(m_coeffs, 0, m_interp * m_paddedTaps * sizeof(float));
+
+    // prototype at the interpolated rate with m_interp gain to make up for the inserted zeros
+    int nbTaps = m_interp * m_tapsPerPhase;
+    double fc = 0.45 / (m_interp > m_decim ? m_interp : m_decim); // relative to the interpolated rate
+    double center = (nbTaps - 1) / 2.0;
+
+    for (int n = 0; n < nbTaps; n++)
+    {
+        double x = n - center;
+        double sinc = x == 0.0 ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * n / (nbTaps - 1)) + 0.08 * cos(4.0 * M_PI * n / (nbTaps - 1));
+        // tap n applies to input x[k-j] at phase p with n = p + j*m_interp. Store oldest sample first
+        int p = n % m_interp;
+        int j = n / m_interp;
+        m_coeffs[p*m_paddedTaps + (m_tapsPerPhase - 1 - j)] = (float) (m_interp * sinc * window);
+    }
+
+    reset();
+}
+
+void DSDResampler::reset()
+{
+    if (m_history) {
+        memset(m_history, 0, (2*m_tapsPerPhase + 8) * sizeof(float));
+    }
+
+    m_index = 0;
+    m_phase = 0;
+}
+
+int DSDResampler::run(short sample, short *out)
+{
+    if (isPassThrough())
+    {
+        *out = sample;
+        return 1;
+    }
+
+    int nbOut = 0;
+    push(sample);
+
+    while (m_phase < m_interp)
+    {
+        out[nbOut++] = clip(m_dot(&m_coeffs[m_phase*m_paddedTaps], &m_history[m_index], m_paddedTaps));
+        m_phase += m_decim;
+    }
+
+    m_phase -= m_interp;
+    return nbOut;
+}
+
+unsigned int DSDResampler::run(const short *in, unsigned int nbSamples, short *out)
+{
+    unsigned int nbOut = 0;
+
+    for (unsigned int i = 0; i < nbSamples; i++) {
+        nbOut += run(in[i], &out[nbOut]);
+    }
+
+    return nbOut;
+}
+
+} // namespace DSDcc
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_RESAMPLER_H_
+#define DSDCC_DSD_RESAMPLER_H_
+
+#include "dsd_fir.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Rational polyphase resampler. The rate change interp/decim is the ratio of output to input rates
+ * reduced by their greatest common divisor. The prototype low pass filter is a Blackman windowed sinc
+ * cut at 0.45 times the lower of the two rates and is split in interp phases of tapsPerPhase taps each.
+ * Each output sample is a dot product of one phase with the input history using the FIR SIMD kernels.
+ */
+class DSDCC_API DSDResampler
+{
+public:
+    DSDResampler();
+    ~DSDResampler();
+
+    void setRates(int inRate, int outRate, int tapsPerPhase = 32); //!< no effect if unchanged. The rates must be supported (see isSupported)
+    void reset();
+
+    bool isPassThrough() const { return m_interp == m_decim; }
+    int getMaxOutputs() const { return (m_interp + m_decim - 1) / m_decim; } //!< maximum number of output samples for one input sample
+    int getInRate() const { return m_inRate; }
+    int getOutRate() const { return m_outRate; }
+    static bool isSupported(int inRate, int outRate); //!< false if the interpolation factor exceeds m_maxInterp
+
+    static const int m_maxInterp = 1024; //!< keeps the coefficients table reasonable
+
+    int run(short sample, short *out); //!< push one input sample. Returns the number of samples written to out (at most getMaxOutputs())
+    unsigned int run(const short *in, unsigned int nbSamples, short *out); //!< block mode. out must hold nbSamples*getMaxOutputs() samples
+
+private:
+    DSDResampler(const DSDResampler&);            //!< not copyable: owns its buffers
+    DSDResampler& operator=(const DSDResampler&); //!< not implemented
+
+    void push(short sample)
+    {
+        m_history[m_index] = sample;
+        m_history[m_index + m_tapsPerPhase] = sample;
+        m_index = (m_index + 1 == m_tapsPerPhase) ? 0 : m_index + 1;
+    }
+
+    static short clip(float v)
+    {
+        return v > 32767.0f ? 32767 : v < -32768.0f ? -32768 : (short) (v < 0.0f ? v - 0.5f : v + 0.5f);
+    }
+
+    int m_inRate;
+    int m_outRate;
+    int m_interp;       //!< interpolation factor i.e. number of phases
+    int m_decim;        //!< decimation factor
+    int m_tapsPerPhase;
+    int m_paddedTaps;   //!< taps per phase rounded up to the SIMD width (extra coefficients are zero)
+    float *m_coeffs;    //!< m_interp phases of m_paddedTaps coefficients oldest sample first
+    float *m_history;   //!< 2 * m_tapsPerPhase samples plus padding
+    int m_index;        //!< next write index. Window is m_history[m_index .. m_index + m_tapsPerPhase - 1]
+    int m_phase;        //!< phase of the next output sample relative to the last input sample
+    DSDFIRFilter::DotKernel m_dot;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_RESAMPLER_H_ */
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_SIMD_H_
+#define DSDCC_DSD_SIMD_H_
+
+/**
+ * Run time instruction set detection for the vectorized kernels.
+ * Kernels for a given instruction set are compiled with DSD_SIMD_TARGET so that the
+ * rest of the library keeps the baseline compiler flags.
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DSD_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define DSD_SIMD_TARGET(x)
+#else
+#define DSD_SIMD_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+namespace DSDcc
+{
+
+class DSDSimd
+{
+public:
+    static bool hasSSE2()
+    {
+#if defined(DSD_SIMD_X86)
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[3] & (1<<26)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+#endif
+#else
+        return false;
+#endif
+    }
+
+    static bool hasAVX2()
+    {
+#if defined(DSD_SIMD_X86)
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+
+        if (info[0] < 7) {
+            return false;
+        }
+
+        __cpuid(info, 1);
+
+        if (((info[2] & (1<<27)) == 0) || ((info[2] & (1<<28)) == 0)) { // OSXSAVE and AVX
+            return false;
+        }
+
+        if ((_xgetbv(0) & 6) != 6) { // XMM and YMM state enabled by the OS
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1<<5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+#else
+        return false;
+#endif
+    }
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_SIMD_H_ */
@@ -14,10 +14,17 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#define _USE_MATH_DEFINES
 #include <iostream>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <assert.h>
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 #include "dsd_symbol.h"
 #include "dsd_decoder.h"
 
@@ -41,8 +48,20 @@ DSDSymbol::DSDSymbol(DSDDecoder *dsdDecoder) :
         m_ringingFilter(48000.0, 4800.0, 0.99f),
         m_pll(0.1f, 0.003f, 0.25),
         m_binSymbolBuffer(1024),
+        m_softSymbolBuffer(1024),
         m_syncSymbolBuffer(64),
-		m_nonInvertedSyncSymbolBuffer(64)
+		m_nonInvertedSyncSymbolBuffer(64),
+        m_syncHistory(0),
+        m_nonInvertedSyncHistory(0),
+        m_timingRecovery(TimingZeroCrossing),
+        m_sampleRate(48000),
+        m_baudRate(4800),
+        m_gardnerHalfPeriod(0.0f),
+        m_gardnerKp(0.0f),
+        m_gardnerKi(0.0f),
+        m_gardnerFilter(0),
+        m_gardnerFilterRate(0),
+        m_gardnerFilterBaud(0)
 {
     noCarrier();
     m_umid = 0;
@@ -56,16 +75,19 @@ DSDSymbol::DSDSymbol(DSDDecoder *dsdDecoder) :
     m_symbolSyncQuality = 0;
     m_symbolSyncQualityCounter = 0;
     memcpy(m_zeroCrossingCorrectionProfile, m_zeroCrossingCorrectionProfile4800, 5*sizeof(int));
+    configureGardner();
 }
 
 DSDSymbol::~DSDSymbol()
 {
+    delete m_gardnerFilter;
 }
 
 void DSDSymbol::noCarrier()
 {
     resetSymbol();
     resetZeroCrossing();
+    resetGardner();
     m_max = 0;
     m_min = 0;
     m_center = 0;
@@ -90,6 +112,16 @@ void DSDSymbol::resetZeroCrossing()
     m_zeroCrossingPos = 0;
 }
 
+void DSDSymbol::resetGardner()
+{
+    m_gardnerNextStrobe = m_gardnerHalfPeriod;
+    m_gardnerPeriodOffset = 0.0f;
+    m_gardnerMidStrobe = false;
+    m_gardnerLast = 0.0f;
+    m_gardnerMid = 0.0f;
+    memset(m_gardnerHistory, 0, 4*sizeof(float));
+}
+
 /**
  * Squares the output of the match filter and passes it through a narrow bandpass filter centered on the
  * Symbol rate frequency. Inspired by: http://www.ece.umd.edu/~tretter/commlab/c6713slides/FSKSlides.pdf
@@ -98,33 +130,45 @@ void DSDSymbol::resetZeroCrossing()
  */
 bool DSDSymbol::pushSample(short sample)
 {
+    if (m_timingRecovery == TimingGardner) {
+        return pushSampleGardner(sample);
+    }
+
     // matched filter
 
-    if (m_dsdDecoder->m_opts.use_cosine_filter)
+    if (m_dsdDecoder->m_opts.use_cosine_filter) {
+        sample = matchedFilter(sample);
+    }
+
+    // ringing filter
+
+    short sampleRinging = 0;
+
+    if (!m_noSignal)
     {
-        if (m_samplesPerSymbol == 20) {
-            sample = m_dsdFilters.nxdn_filter(sample); // 6.25 kHz for 2400 baud
-        } else {
-            sample = m_dsdFilters.dmr_filter(sample);  // 12.5 kHz for 4800 and 9600 baud
-        }
+        short sampleSq = ((((int) sample)- m_center) * (((int) sample)- m_center)) >> 15;
+        sampleRinging = m_ringingFilter.run(sampleSq);
     }
 
+    return pushFilteredSample(sample, sampleRinging);
+}
+
+/**
+ * Zero crossing timing and symbol estimation from the matched filter output and the ringing filter
+ * output (ignored when there is no signal). DSDSymbolBank computes both for several channels at once.
+ */
+bool DSDSymbol::pushFilteredSample(short sample, short sampleRinging)
+{
     m_filteredSample = sample;
 
     if (!m_noSignal)
     {
         m_lmmSamples.update(sample); // store for running min/max calculation
 
-        // ringing filter
-        short sampleSq = ((((int) sample)- m_center) * (((int) sample)- m_center)) >> 15;
-        short sampleRinging = m_ringingFilter.run(sampleSq);
-
         if (m_pllLock)
         {
-            float pllOut[2];
             float pllIn = sampleRinging / 32768.0f;
-            m_pll.process(pllIn, pllOut);
-            m_symbolSyncSample = (short)(pllOut[0] * 16384.0f);
+            m_symbolSyncSample = (short)(m_pll.processSin(pllIn) * 16384.0f);
 
             // process with PLL
             if ((m_symbolSyncSample > 0) && (m_lastsample < 0))
@@ -269,61 +313,183 @@ bool DSDSymbol::pushSample(short sample)
         }
 
         m_symbol = m_sum / m_count;
-        m_dsdDecoder->m_state.symbolcnt++;
-
-        digitizeIntoBinaryBuffer();
         resetSymbol();
+        concludeSymbol();
 
-        // moved here what was done at symbol retrieval in the decoder
+        return true; // new symbol available
+    }
+    else
+    {
+        m_sampleIndex++; // wait for next sample
+        return false;
+    }
+}
 
-        // symbol synchronization quality metric
+/**
+ * Fractional timing recovery. The matched filter output is interpolated twice per symbol by a cubic
+ * Farrow interpolator: once on time and once half way between symbols. The Gardner detector
+ * (y[k] - y[k-1]) * y[k-1/2] moves the next strobe with a proportional plus integral loop so the
+ * symbol period need not be an integer number of samples. Needs at least 2 samples per symbol.
+ */
+bool DSDSymbol::pushSampleGardner(short sample)
+{
+    // matched filter
 
-        if (m_symbolSyncQualityCounter < 99)
-        {
-            m_symbolSyncQualityCounter++;
-        }
-        else
-        {
-            m_symbolSyncQuality = m_numflips;
-            m_symbolSyncQualityCounter = 0;
-            m_numflips = 0;
+    if (m_dsdDecoder->m_opts.use_cosine_filter)
+    {
+        if (m_gardnerFilter) {
+            sample = m_gardnerFilter->run(sample);
+        } else {
+            sample = matchedFilter(sample);
         }
+    }
+
+    m_filteredSample = sample;
+
+    if (!m_noSignal) {
+        m_lmmSamples.update(sample); // store for running min/max calculation
+    }
+
+    m_gardnerHistory[0] = m_gardnerHistory[1];
+    m_gardnerHistory[1] = m_gardnerHistory[2];
+    m_gardnerHistory[2] = m_gardnerHistory[3];
+    m_gardnerHistory[3] = sample - m_center;
+    m_gardnerNextStrobe -= 1.0f;
+    m_symbolSyncSample = m_min;
 
-        // min/max calculation
+    bool symbolReady = false;
 
-        if (m_lmmidx < 24)
+    while (m_gardnerNextStrobe <= 0.0f) // strobe falls between m_gardnerHistory[1] and m_gardnerHistory[2]
+    {
+        float y = interpolateCubic(m_gardnerHistory, 1.0f + m_gardnerNextStrobe);
+
+        if (m_gardnerMidStrobe)
         {
-            m_lmmidx++;
+            m_gardnerMid = y;
+            m_gardnerNextStrobe += m_gardnerHalfPeriod;
         }
         else
         {
-            m_lmmidx = 0;
-            snapMinMax();
+            float correction = 0.0f;
+            int span = (m_max - m_min) / 2;
+
+            if (!m_noSignal && (span > 0))
+            {
+                float error = ((y - m_gardnerLast) * m_gardnerMid) / ((float) span * span);
+
+                if (error > 1.0f) {
+                    error = 1.0f;
+                } else if (error < -1.0f) {
+                    error = -1.0f;
+                }
+
+                m_gardnerPeriodOffset -= m_gardnerKi * error;
+
+                if (m_gardnerPeriodOffset > m_gardnerMaxOffset) {
+                    m_gardnerPeriodOffset = m_gardnerMaxOffset;
+                } else if (m_gardnerPeriodOffset < -m_gardnerMaxOffset) {
+                    m_gardnerPeriodOffset = -m_gardnerMaxOffset;
+                }
+
+                correction = m_gardnerPeriodOffset - m_gardnerKp * error; // late strobe gives positive error
+            }
+
+            m_zeroCrossingPos = (int) roundf(correction);
+
+            if (fabsf(correction) > m_gardnerHalfPeriod / 25.0f) {
+                m_numflips++;
+            }
+
+            m_gardnerLast = y;
+            m_gardnerNextStrobe += m_gardnerHalfPeriod + correction;
+            m_symbolSyncSample = m_max;
+            m_symbol = (int) y + m_center;
+            concludeSymbol();
+            symbolReady = true;
         }
 
-        return true; // new symbol available
+        m_gardnerMidStrobe = !m_gardnerMidStrobe;
+    }
+
+    return symbolReady;
+}
+
+short DSDSymbol::matchedFilter(short sample)
+{
+    return m_dsdFilters.matchedFilter(m_sampleRate, m_baudRate).run(sample);
+}
+
+void DSDSymbol::concludeSymbol()
+{
+    m_dsdDecoder->m_state.symbolcnt++;
+    digitizeIntoBinaryBuffer();
+
+    // moved here what was done at symbol retrieval in the decoder
+
+    // symbol synchronization quality metric
+
+    if (m_symbolSyncQualityCounter < 99)
+    {
+        m_symbolSyncQualityCounter++;
     }
     else
     {
-        m_sampleIndex++; // wait for next sample
-        return false;
+        m_symbolSyncQuality = m_numflips;
+        m_symbolSyncQualityCounter = 0;
+        m_numflips = 0;
+    }
+
+    // min/max calculation
+
+    if (m_lmmidx < 24)
+    {
+        m_lmmidx++;
+    }
+    else
+    {
+        m_lmmidx = 0;
+        snapMinMax();
     }
 }
 
-void DSDSymbol::snapLevels(int nbSymbols)
+/**
+ * Farrow structure of the 4 point Lagrange interpolator. h[0..3] are samples at t = -2, -1, 0, 1
+ * and the result is at t = mu - 1 i.e. mu in [0,1] spans h[1] to h[2].
+ */
+float DSDSymbol::interpolateCubic(const float *h, float mu)
 {
-    memcpy(m_lbuf2, &m_lbuf[32 + m_lmmidx - nbSymbols], nbSymbols * sizeof(int)); // copy to working buffer
-    qsort(m_lbuf2, nbSymbols, sizeof(int), comp);
+    float c1 = -h[0]/3.0f - h[1]/2.0f + h[2] - h[3]/6.0f;
+    float c2 = (h[0] + h[2])/2.0f - h[1];
+    float c3 = (h[3] - h[0])/6.0f + (h[1] - h[2])/2.0f;
+    return ((c3*mu + c2)*mu + c1)*mu + h[1];
+}
 
-    int lmin = (m_lbuf2[2] + m_lbuf2[3] + m_lbuf2[4]) / 3;
-    int lmax = (m_lbuf2[nbSymbols-3] + m_lbuf2[nbSymbols-4] + m_lbuf2[nbSymbols-5]) / 3;
+void DSDSymbol::designRRC(float *coeffs, int nbTaps, float samplesPerSymbol, float rolloff)
+{
+    int center = nbTaps / 2;
 
-    m_max = m_max + (lmax - m_max) / 4; // alpha = 0.25
-    m_min = m_min + (lmin - m_min) / 4; // alpha = 0.25
-    // recalibrate center/umid/lmid
-    m_center = ((m_max) + (m_min)) / 2;
-    m_umid = (((m_max) - m_center) / 2) + m_center;
-    m_lmid = (((m_min) - m_center) / 2) + m_center;
+    for (int i = 0; i < nbTaps; i++)
+    {
+        double t = (i - center) / samplesPerSymbol; // in symbols
+        double h;
+
+        if (fabs(t) < 1e-6)
+        {
+            h = 1.0 - rolloff + 4.0*rolloff/M_PI;
+        }
+        else if (fabs(fabs(4.0*rolloff*t) - 1.0) < 1e-6)
+        {
+            h = (rolloff/sqrt(2.0)) * ((1.0 + 2.0/M_PI) * sin(M_PI/(4.0*rolloff))
+                    + (1.0 - 2.0/M_PI) * cos(M_PI/(4.0*rolloff)));
+        }
+        else
+        {
+            h = (sin(M_PI*t*(1.0 - rolloff)) + 4.0*rolloff*t*cos(M_PI*t*(1.0 + rolloff)))
+                    / (M_PI*t*(1.0 - (4.0*rolloff*t)*(4.0*rolloff*t)));
+        }
+
+        coeffs[i] = (float) h;
+    }
 }
 
 void DSDSymbol::snapMinMax()
@@ -356,44 +522,139 @@ void DSDSymbol::setFSK(unsigned int nbSymbols, bool inverted)
 
 void DSDSymbol::setSamplesPerSymbol(int samplesPerSymbol)
 {
-    m_samplesPerSymbol = samplesPerSymbol;
+    m_baudRate = 48000 / (samplesPerSymbol == 5 || samplesPerSymbol == 20 ? samplesPerSymbol : 10);
+    configureSymbolRate();
+}
+
+bool DSDSymbol::isNativeRate(int sampleRate, int baudRate)
+{
+    if ((sampleRate != 48000) && (sampleRate != 24000) && (sampleRate != 12000)) { // matched filter tables
+        return false;
+    }
+
+    if (sampleRate % baudRate != 0) {
+        return false;
+    }
+
+    int samplesPerSymbol = sampleRate / baudRate;
+    return (samplesPerSymbol == 5) || (samplesPerSymbol == 10) || (samplesPerSymbol == 20);
+}
+
+/**
+ * Gardner timing takes any rate of at least 2 samples per symbol. Below that the input is resampled
+ * to 48 kS/s as for the zero crossing timing at rates that are not native.
+ */
+int DSDSymbol::getChainRate(int inputRate, int baudRate, TimingRecovery timingRecovery)
+{
+    if ((timingRecovery == TimingGardner) && (inputRate >= 2*baudRate)) {
+        return inputRate;
+    }
+
+    return isNativeRate(inputRate, baudRate) ? inputRate : 48000;
+}
+
+/**
+ * The zero crossing timing works on an integer number of samples per symbol. The symbol and sample
+ * rates pairs of isNativeRate all fall on 5, 10 or 20 samples per symbol so the correction profiles,
+ * PLL settings and windows are those of the corresponding symbol rate at 48 kS/s.
+ */
+void DSDSymbol::configureSymbolRate()
+{
+    m_samplesPerSymbol = m_sampleRate / m_baudRate;
 
     if (m_samplesPerSymbol == 5)
     {
         memcpy(m_zeroCrossingCorrectionProfile, m_zeroCrossingCorrectionProfile9600, 11*sizeof(int));
         m_zeroCrossingSlopeDivisor = 164;
         m_lmmSamples.resize(5*24);
-        m_ringingFilter.setFrequencies(48000.0f, 9600.0f);
+        m_ringingFilter.setFrequencies(m_sampleRate, m_baudRate);
         m_ringingFilter.setR(0.99f);
         m_pll.configure(0.2f, 0.003f, 0.25f);
     }
-    else if (m_samplesPerSymbol == 10)
-    {
-        memcpy(m_zeroCrossingCorrectionProfile, m_zeroCrossingCorrectionProfile4800, 11*sizeof(int));
-        m_zeroCrossingSlopeDivisor = 232;
-        m_lmmSamples.resize(10*24);
-        m_ringingFilter.setFrequencies(48000.0f, 4800.0f);
-        m_ringingFilter.setR(0.99f);
-        m_pll.configure(0.1f, 0.003f, 0.25f);
-    }
     else if (m_samplesPerSymbol == 20)
     {
         memcpy(m_zeroCrossingCorrectionProfile, m_zeroCrossingCorrectionProfile2400, 11*sizeof(int));
         m_zeroCrossingSlopeDivisor = 328;
         m_lmmSamples.resize(20*24);
-        m_ringingFilter.setFrequencies(48000.0f, 2400.0f);
+        m_ringingFilter.setFrequencies(m_sampleRate, m_baudRate);
         m_ringingFilter.setR(0.996f);
         m_pll.configure(0.05f, 0.003f, 0.25f);
     }
-    else
+    else // 10 samples per symbol - default
     {
         memcpy(m_zeroCrossingCorrectionProfile, m_zeroCrossingCorrectionProfile4800, 11*sizeof(int));
         m_zeroCrossingSlopeDivisor = 232;
         m_lmmSamples.resize(10*24);
-        m_ringingFilter.setFrequencies(48000.0f, 4800.0f);
+        m_ringingFilter.setFrequencies(m_sampleRate, m_baudRate);
         m_ringingFilter.setR(0.99f);
         m_pll.configure(0.1f, 0.003f, 0.25f);
     }
+
+    if (m_timingRecovery == TimingGardner) {
+        configureGardner();
+    }
+}
+
+void DSDSymbol::setTimingRecovery(TimingRecovery timingRecovery)
+{
+    m_timingRecovery = timingRecovery;
+
+    configureSymbolRate();
+    resetSymbol();
+    resetGardner();
+}
+
+void DSDSymbol::setSampleRate(int sampleRate)
+{
+    m_sampleRate = sampleRate;
+    configureSymbolRate();
+}
+
+/**
+ * Gains are relative to the symbol period. The integral part only absorbs a small symbol clock
+ * offset (1%) so that it does not wander on noise or 4FSK self noise. The root raised cosine matched
+ * filter spans 8 symbols and is normalized to unity DC gain as the 48 kS/s ones are. Full rolloff
+ * gave better results than 0.2 on discriminator output samples.
+ */
+void DSDSymbol::configureGardner()
+{
+    float samplesPerSymbol = (float) m_sampleRate / m_baudRate;
+    float halfPeriod = samplesPerSymbol / 2.0f;
+
+    if (halfPeriod != m_gardnerHalfPeriod)
+    {
+        m_gardnerHalfPeriod = halfPeriod;
+        m_gardnerKp = 0.1f * samplesPerSymbol;
+        m_gardnerKi = 0.0002f * samplesPerSymbol;
+        m_gardnerMaxOffset = 0.01f * samplesPerSymbol;
+        m_gardnerPeriodOffset = 0.0f;
+    }
+
+    m_lmmSamples.resize((int) (samplesPerSymbol * 24.0f + 0.5f)); // configureSymbolRate has set it for the nearest native rate
+
+    if (m_sampleRate == 48000)
+    {
+        delete m_gardnerFilter;
+        m_gardnerFilter = 0;
+        m_gardnerFilterRate = 0;
+    }
+    else if ((m_sampleRate != m_gardnerFilterRate) || (m_baudRate != m_gardnerFilterBaud))
+    {
+        int nbTaps = 2 * (int) (4.0f * samplesPerSymbol + 0.5f) + 1;
+        float *coeffs = new float[nbTaps];
+        designRRC(coeffs, nbTaps, samplesPerSymbol, 1.0f);
+        float gain = 0.0f;
+
+        for (int i = 0; i < nbTaps; i++) {
+            gain += coeffs[i];
+        }
+
+        delete m_gardnerFilter;
+        m_gardnerFilter = new DSDFIRFilter(coeffs, nbTaps, gain);
+        m_gardnerFilterRate = m_sampleRate;
+        m_gardnerFilterBaud = m_baudRate;
+        delete[] coeffs;
+    }
 }
 
 int DSDSymbol::get_dibit()
@@ -455,13 +716,71 @@ unsigned char DSDSymbol::digitize(int symbol)
 	}
 }
 
+/**
+ * Soft counterpart of digitize. Each bit of the dibit gets a value from 0 (certain 0) to 15 (certain 1)
+ * with the decision threshold between 7 and 8. The distance to the threshold is scaled so that the
+ * value saturates at the mid level between the inner and outer symbols. For 2FSK the single bit is
+ * in the low nibble.
+ */
+unsigned char DSDSymbol::softDigitize(int symbol)
+{
+    int uspan = m_umid - m_center;
+    int lspan = m_center - m_lmid;
+
+    if (m_nbFSKSymbols == 2)
+    {
+        unsigned char bit = softBit(m_center - symbol, symbol > m_center ? uspan : lspan);
+        return m_invertedFSK ? 15 - bit : bit;
+    }
+    else if (m_nbFSKSymbols == 4)
+    {
+        unsigned char msb; // 1 for negative symbols (-1, -3)
+        unsigned char lsb; // 1 for outer symbols (+3, -3)
+
+        if (symbol > m_center)
+        {
+            msb = softBit(m_center - symbol, uspan);
+            lsb = softBit(symbol - m_umid, uspan);
+        }
+        else
+        {
+            msb = softBit(m_center - symbol, lspan);
+            lsb = softBit(m_lmid - symbol, lspan);
+        }
+
+        return ((m_invertedFSK ? 15 - msb : msb) << 4) + lsb;
+    }
+    else // invalid
+    {
+        return 0;
+    }
+}
+
+unsigned char DSDSymbol::softBit(int distance, int span)
+{
+    if (span <= 0) { // levels not yet established
+        return distance > 0 ? 15 : 0;
+    }
+
+    if (distance > span) {
+        distance = span;
+    } else if (distance < -span) {
+        distance = -span;
+    }
+
+    return (15*(distance + span) + span) / (2*span);
+}
+
 void DSDSymbol::digitizeIntoBinaryBuffer()
 {
     // determine dibit state
     unsigned char binSymbol = digitize(m_symbol);
     m_binSymbolBuffer.push(binSymbol);
+    m_softSymbolBuffer.push(softDigitize(m_symbol));
     m_syncSymbolBuffer.push(m_symbol > 0 ? 1 : 3);
     m_nonInvertedSyncSymbolBuffer.push((m_invertedFSK ? (m_symbol <= 0) : (m_symbol > 0)) ? 1 : 3);
+    m_syncHistory = (m_syncHistory << 1) | (m_symbol > 0 ? 0 : 1);
+    m_nonInvertedSyncHistory = (m_nonInvertedSyncHistory << 1) | ((m_invertedFSK ? (m_symbol <= 0) : (m_symbol > 0)) ? 0 : 1);
 }
 
 int DSDSymbol::invert_dibit(int dibit)
@@ -488,16 +807,6 @@ int DSDSymbol::getDibit()
     return get_dibit();
 }
 
-int DSDSymbol::comp(const void *a, const void *b)
-{
-    if (*((const int *) a) == *((const int *) b))
-        return 0;
-    else if (*((const int *) a) < *((const int *) b))
-        return -1;
-    else
-        return 1;
-}
-
 int DSDSymbol::compShort(const void *a, const void *b)
 {
     if (*((const short *) a) == *((const short *) b))
@@ -17,6 +17,8 @@
 #ifndef DSD_SYMBOL_H_
 #define DSD_SYMBOL_H_
 
+#include <stdint.h>
+
 #include "dsd_filters.h"
 #include "doublebuffer.h"
 #include "runningmaxmin.h"
@@ -30,24 +32,38 @@ class DSDDecoder;
 
 class DSDCC_API DSDSymbol
 {
+    template<int N> friend class DSDSymbolBank;
+
 public:
+    typedef enum
+    {
+        TimingZeroCrossing, //!< integer sample index nudged by the ringing filter zero crossings. 48 kS/s only
+        TimingGardner       //!< Gardner detector driving a cubic interpolator. Any rate down to 2 samples per symbol (see getChainRate)
+    } TimingRecovery;
+
     explicit DSDSymbol(DSDDecoder *dsdDecoder);
     ~DSDSymbol();
 
     void noCarrier();
     void resetFrameSync();
 
-    void snapLevels(int nbSymbols); //!< take snapshot for min/max over a number of symbols
-    void setSamplesPerSymbol(int samplesPerSymbol);
+    void setSamplesPerSymbol(int samplesPerSymbol); //!< at 48 kS/s. Sets the symbol rate: 5 is 9600, 10 is 4800 and 20 is 2400 baud
+    void setTimingRecovery(TimingRecovery timingRecovery);
+    void setSampleRate(int sampleRate); //!< rate of the pushed samples. Rates that are not native (see isNativeRate) require TimingGardner
     void setFSK(unsigned int nbSymbols, bool inverted=false);
     void setNoSignal(bool noSignal) { m_noSignal = noSignal; }
     bool pushSample(short sample); //!< push a new sample into the decoder. Returns true if a new symbol is available
+    bool pushFilteredSample(short sample, short sampleRinging); //!< same as pushSample with the matched filter and ringing filter outputs. Zero crossing timing only
 
     int getSymbol() const { return m_symbol; }
     int getDibit(); //!< from the last retrieved symbol Returns either the bit (0,1) or the dibit value (0,1,2,3)
     unsigned char *getDibitBack(unsigned int shift) { return m_binSymbolBuffer.getBack(shift); }
     unsigned char *getSyncDibitBack(unsigned int shift) { return m_syncSymbolBuffer.getBack(shift); }
     unsigned char *getNonInvertedSyncDibitBack(unsigned int shift) { return m_nonInvertedSyncSymbolBuffer.getBack(shift); }
+    int getSoftDibit() { return m_softSymbolBuffer.getLatest(); } //!< soft values of the last retrieved symbol bits. See softDigitize
+    unsigned char *getSoftDibitBack(unsigned int shift) { return m_softSymbolBuffer.getBack(shift); }
+    uint64_t getSyncHistory() const { return m_syncHistory; }
+    uint64_t getNonInvertedSyncHistory() const { return m_nonInvertedSyncHistory; }
 
     static int invert_dibit(int dibit);
     int getLevel() const { return (m_max - m_min) / 328; }
@@ -57,6 +73,11 @@ public:
     short getFilteredSample() const { return m_filteredSample; }
     short getSymbolSyncSample() const { return m_symbolSyncSample; }
     int getSamplesPerSymbol() const { return m_samplesPerSymbol; }
+    TimingRecovery getTimingRecovery() const { return m_timingRecovery; }
+    int getSampleRate() const { return m_sampleRate; }
+    int getBaudRate() const { return m_baudRate; }
+    static bool isNativeRate(int sampleRate, int baudRate); //!< true if the zero crossing timing and matched filters support this sample rate at this symbol rate
+    static int getChainRate(int inputRate, int baudRate, TimingRecovery timingRecovery); //!< input rate if it can be processed natively else 48 kS/s
     bool getPLLLocked() const { return m_pllLock && m_pll.locked(); }
     void setPLLLock(bool pllLock) { m_pllLock = pllLock; }
 
@@ -78,12 +99,21 @@ public:
 private:
     void resetSymbol();
     void resetZeroCrossing();
+    void resetGardner();
+    void configureSymbolRate();
+    void configureGardner();
+    short matchedFilter(short sample);
+    bool pushSampleGardner(short sample);
+    void concludeSymbol(); //!< digitize m_symbol and update the quality and level trackers
+    static float interpolateCubic(const float *h, float mu);
+    static void designRRC(float *coeffs, int nbTaps, float samplesPerSymbol, float rolloff);
     int get_dibit();
 //    void use_symbol(int symbol);
     unsigned char digitize(int symbol);
+    unsigned char softDigitize(int symbol);
+    static unsigned char softBit(int distance, int span);
     void digitizeIntoBinaryBuffer();
     void snapMinMax();
-    static int comp(const void *a, const void *b);
     static int compShort(const void *a, const void *b);
 
     DSDDecoder *m_dsdDecoder;
@@ -101,8 +131,7 @@ private:
     int m_zeroCrossingCorrectionProfile[11];
     int m_zeroCrossingSlopeDivisor;
 
-    int m_lbuf[32*2], m_lbuf2[32]; //!< symbol buffers for min/max
-    int m_lmmidx;                  //!< index in min/max symbol buffer
+    int m_lmmidx;                  //!< symbols since last min/max snapshot
     int m_min, m_max;
     int m_center;
     int m_umid, m_lmid;
@@ -120,8 +149,28 @@ private:
     DSDSecondOrderRecursiveFilter m_ringingFilter;
     SimplePhaseLock m_pll;
     DoubleBuffer<unsigned char> m_binSymbolBuffer;    //!< digitized symbol
+    DoubleBuffer<unsigned char> m_softSymbolBuffer;   //!< soft digitized symbol: 4 bit soft values of dibit MSB (high nibble) and LSB (low nibble)
     DoubleBuffer<unsigned char> m_syncSymbolBuffer;   //!< symbol digitized for synchronization: positive is 1, negative is 3
     DoubleBuffer<unsigned char> m_nonInvertedSyncSymbolBuffer; //!< same but resetting to positive sync
+    uint64_t m_syncHistory;            //!< sync symbols shift register: most recent in LSB, bit set for negative (3)
+    uint64_t m_nonInvertedSyncHistory; //!< same but resetting to positive sync
+
+    TimingRecovery m_timingRecovery;
+    int m_sampleRate;             //!< rate of the pushed samples
+    int m_baudRate;               //!< symbol rate
+    float m_gardnerHalfPeriod;    //!< nominal half symbol period in samples
+    float m_gardnerNextStrobe;    //!< time of the next interpolant in samples relative to m_gardnerHistory[2]
+    float m_gardnerPeriodOffset;  //!< integral part of the loop correction in samples
+    bool m_gardnerMidStrobe;      //!< next interpolant is the mid symbol one
+    float m_gardnerHistory[4];    //!< last 4 matched filter samples newest last
+    float m_gardnerLast;          //!< previous on time interpolant
+    float m_gardnerMid;           //!< last mid symbol interpolant
+    float m_gardnerKp;            //!< loop proportional gain in samples per unit of normalized error
+    float m_gardnerKi;            //!< loop integral gain
+    float m_gardnerMaxOffset;     //!< symbol clock offset limit of the integral part in samples
+    DSDFIRFilter *m_gardnerFilter; //!< root raised cosine matched filter for rates other than 48 kS/s
+    int m_gardnerFilterRate;      //!< sample rate m_gardnerFilter was designed for
+    int m_gardnerFilterBaud;      //!< symbol rate m_gardnerFilter was designed for
 
     static const int m_zeroCrossingCorrectionProfile2400[11];
     static const int m_zeroCrossingCorrectionProfile4800[11];
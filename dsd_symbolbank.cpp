@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "dsd_symbolbank.h"
+#include "dsd_simd.h"
+
+namespace DSDcc
+{
+
+const int DSDSymbolBankBase::m_maxTaps;
+
+static void laneDotScalar(const float *coeffs, const float *history, float *acc, int nbTaps, int nbLanes)
+{
+    for (int l = 0; l < nbLanes; l++) {
+        acc[l] = 0.0f;
+    }
+
+    for (int t = 0; t < nbTaps; t++, coeffs += nbLanes, history += nbLanes)
+    {
+        for (int l = 0; l < nbLanes; l++) {
+            acc[l] += coeffs[l] * history[l];
+        }
+    }
+}
+
+#ifdef DSD_SIMD_X86
+
+DSD_SIMD_TARGET("sse2")
+static void laneDotSSE2(const float *coeffs, const float *history, float *acc, int nbTaps, int nbLanes)
+{
+    for (int l = 0; l < nbLanes; l += 8)
+    {
+        const float *c = coeffs + l;
+        const float *h = history + l;
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+
+        for (int t = 0; t < nbTaps; t++, c += nbLanes, h += nbLanes)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(c), _mm_loadu_ps(h)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(c + 4), _mm_loadu_ps(h + 4)));
+        }
+
+        _mm_storeu_ps(acc + l, acc0);
+        _mm_storeu_ps(acc + l + 4, acc1);
+    }
+}
+
+/** Two accumulators on alternate taps to halve the add latency chain */
+DSD_SIMD_TARGET("avx2")
+static void laneDotAVX2(const float *coeffs, const float *history, float *acc, int nbTaps, int nbLanes)
+{
+    int stride = 2*nbLanes;
+
+    for (int l = 0; l < nbLanes; l += 8)
+    {
+        const float *c = coeffs + l;
+        const float *h = history + l;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        int t = 0;
+
+        for (; t + 1 < nbTaps; t += 2, c += stride, h += stride)
+        {
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(c), _mm256_loadu_ps(h)));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(c + nbLanes), _mm256_loadu_ps(h + nbLanes)));
+        }
+
+        if (t < nbTaps) {
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(c), _mm256_loadu_ps(h)));
+        }
+
+        _mm256_storeu_ps(acc + l, _mm256_add_ps(acc0, acc1));
+    }
+}
+
+#endif // DSD_SIMD_X86
+
+DSDSymbolBankBase::LaneDotKernel DSDSymbolBankBase::selectKernel()
+{
+#ifdef DSD_SIMD_X86
+    if (DSDSimd::hasAVX2()) {
+        return laneDotAVX2;
+    }
+
+    if (DSDSimd::hasSSE2()) {
+        return laneDotSSE2;
+    }
+#endif
+    return laneDotScalar;
+}
+
+const char *DSDSymbolBankBase::getKernelName()
+{
+    LaneDotKernel dot = selectKernel();
+#ifdef DSD_SIMD_X86
+    if (dot == laneDotAVX2) {
+        return "AVX2";
+    } else if (dot == laneDotSSE2) {
+        return "SSE2";
+    }
+#endif
+    return "scalar";
+}
+
+} // namespace DSDcc
@@ -0,0 +1,306 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_SYMBOLBANK_H_
+#define DSDCC_DSD_SYMBOLBANK_H_
+
+#include <string.h>
+
+#include "dsd_decoder.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Lane dot product kernels of DSDSymbolBank: acc[l] = sum over t of coeffs[t*nbLanes + l] * history[t*nbLanes + l]
+ */
+class DSDCC_API DSDSymbolBankBase
+{
+public:
+    typedef void (*LaneDotKernel)(const float *coeffs, const float *history, float *acc, int nbTaps, int nbLanes); //!< nbLanes must be a multiple of 8
+
+    static const char *getKernelName();
+    static LaneDotKernel selectKernel(); //!< best lane dot product kernel for this CPU
+
+    static const int m_maxTaps = NXZEROS + 1; //!< longest matched filter
+};
+
+/**
+ * Front end of the symbol chain of N channels (lanes) running at the same sample rate with zero
+ * crossing timing. The input history and matched filter coefficients of all lanes are held in
+ * structure of arrays layout so that a block of samples of all lanes is filtered with vector
+ * instructions across lanes. Each lane then runs the ringing filter, timing recovery, symbol
+ * estimation and protocol state machine of its decoder over the block, as DSDDecoder::run does,
+ * so that the decoder state stays in cache for the whole block.
+ *
+ * Lanes follow the symbol rate and matched filter changes of their decoder, including changes in
+ * the middle of a block. Lanes whose decoder uses DSDDecodeAutoRate, Gardner timing, another sample
+ * rate or input resampling are passed to DSDDecoder::run. The lane kernels add the taps in another
+ * order than the DSDFIRFilter kernels so the filtered samples may differ from DSDDecoder::run in the
+ * last bits. The decoders are not owned.
+ */
+template<int N>
+class DSDSymbolBank : public DSDSymbolBankBase
+{
+public:
+    explicit DSDSymbolBank(int sampleRate) : //!< 48000, 24000 or 12000
+        m_sampleRate(sampleRate),
+        m_firstTap(m_maxTaps - 1)
+    {
+        static_assert((N > 0) && (N % 8 == 0), "lanes must be a multiple of 8");
+        memset(m_history, 0, sizeof(m_history));
+        memset(m_coeffs, 0, sizeof(m_coeffs));
+
+        for (int lane = 0; lane < N; lane++)
+        {
+            m_decoders[lane] = 0;
+            clearLane(lane);
+        }
+
+        m_dot = selectKernel();
+    }
+
+    void setDecoder(int lane, DSDDecoder *decoder) //!< 0 leaves the lane idle
+    {
+        m_decoders[lane] = decoder;
+        clearLane(lane);
+    }
+
+    DSDDecoder *getDecoder(int lane) const { return m_decoders[lane]; }
+    int getSampleRate() const { return m_sampleRate; }
+
+    /** samples[i*N + lane] is sample i of lane. Returns the number of AMBE/IMBE frames that became ready */
+    int run(const short *samples, unsigned int nbSamples)
+    {
+        int nbFrames = 0;
+
+        while (nbSamples > 0)
+        {
+            int n = nbSamples < (unsigned int) m_blockSize ? nbSamples : m_blockSize;
+            bool lockstep[N];
+
+            for (int lane = 0; lane < N; lane++) {
+                lockstep[lane] = m_decoders[lane] && followDecoder(lane);
+            }
+
+            for (int i = 0; i < n; i++)
+            {
+                for (int lane = 0; lane < N; lane++) {
+                    m_history[m_maxTaps - 1 + i][lane] = samples[i*N + lane];
+                }
+            }
+
+            for (int i = 0; i < n; i++) {
+                m_dot(m_coeffs[m_firstTap], m_history[i + m_firstTap], m_filtered[i], m_maxTaps - m_firstTap, N);
+            }
+
+            for (int lane = 0; lane < N; lane++)
+            {
+                if (lockstep[lane]) {
+                    nbFrames += runLane(lane, samples, n);
+                } else if (m_decoders[lane]) {
+                    short laneSamples[m_blockSize];
+
+                    for (int i = 0; i < n; i++) {
+                        laneSamples[i] = samples[i*N + lane];
+                    }
+
+                    nbFrames += m_decoders[lane]->run(laneSamples, n);
+                }
+            }
+
+            memmove(m_history[0], m_history[n], (m_maxTaps - 1) * N * sizeof(float));
+            samples += n*N;
+            nbSamples -= n;
+        }
+
+        return nbFrames;
+    }
+
+private:
+    int runLane(int lane, const short *samples, int n)
+    {
+        DSDDecoder *decoder = m_decoders[lane];
+        const DSDSymbol& symbol = decoder->m_dsdSymbol;
+        int nbFrames = 0;
+
+        for (int i = 0; i < n; i++)
+        {
+            int signature = getSignature(lane);
+
+            if (signature != m_signature[lane]) // the decoder switched symbol rate or filter on the previous symbol
+            {
+                configureLane(lane, signature);
+                filterLane(lane, i, n);
+            }
+
+            short filtered = (short) (m_filtered[i][lane] / m_gain[lane]);
+            short ringing = 0;
+
+            if (!symbol.m_noSignal) // as DSDSecondOrderRecursiveFilter::run
+            {
+                short sampleSq = ((((int) filtered) - symbol.m_center) * (((int) filtered) - symbol.m_center)) >> 15;
+                float v0 = (m_ringingB0[lane] * (float) sampleSq) + (m_ringingA1[lane] * m_ringingV1[lane]) - (m_ringingA2[lane] * m_ringingV2[lane]);
+                ringing = (short) (v0 - m_ringingV2[lane]);
+                m_ringingV2[lane] = m_ringingV1[lane];
+                m_ringingV1[lane] = v0;
+            }
+
+            nbFrames += decoder->processFilteredSample(samples[i*N + lane], filtered, ringing);
+        }
+
+        return nbFrames;
+    }
+
+    /**
+     * Returns false if the lane cannot run on the bank. The rate probes of DSDDecodeAutoRate may switch
+     * the data rate, and with it the input resampler, in the middle of a block and they replay their
+     * history through the matched filter of the decoder that the lane does not feed. Such decoders
+     * are not run on the bank.
+     */
+    bool followDecoder(int lane)
+    {
+        DSDDecoder *decoder = m_decoders[lane];
+        const DSDSymbol& symbol = decoder->m_dsdSymbol;
+
+        if (decoder->m_autoRate
+         || (symbol.m_timingRecovery != DSDSymbol::TimingZeroCrossing)
+         || (symbol.m_sampleRate != m_sampleRate)
+         || !decoder->m_inputResampler.isPassThrough())
+        {
+            m_signature[lane] = 0;
+            return false;
+        }
+
+        int signature = getSignature(lane);
+
+        if (signature != m_signature[lane]) {
+            configureLane(lane, signature);
+        }
+
+        return true;
+    }
+
+    int getSignature(int lane) const //!< symbol rate and matched filter use that the lane filters depend on
+    {
+        const DSDDecoder *decoder = m_decoders[lane];
+        return 2*decoder->m_dsdSymbol.m_baudRate + (decoder->m_opts.use_cosine_filter ? 1 : 0);
+    }
+
+    void configureLane(int lane, int signature)
+    {
+        DSDSymbol& symbol = m_decoders[lane]->m_dsdSymbol;
+
+        for (int t = 0; t < m_maxTaps; t++) {
+            m_coeffs[t][lane] = 0.0f;
+        }
+
+        if (signature & 1)
+        {
+            const DSDFIRFilter& filter = symbol.m_dsdFilters.matchedFilter(m_sampleRate, symbol.m_baudRate);
+            const float *coeffs = filter.getCoeffs();
+            int nbTaps = filter.getNbTaps();
+
+            for (int t = 0; t < nbTaps; t++) { // newest sample last
+                m_coeffs[m_maxTaps - nbTaps + t][lane] = coeffs[t];
+            }
+
+            m_gain[lane] = filter.getGain();
+        }
+        else
+        {
+            m_coeffs[m_maxTaps - 1][lane] = 1.0f;
+            m_gain[lane] = 1.0f;
+        }
+
+        const DSDSecondOrderRecursiveFilter& ringingFilter = symbol.m_ringingFilter;
+        m_ringingB0[lane] = ringingFilter.getB0();
+        m_ringingA1[lane] = ringingFilter.getA1();
+        m_ringingA2[lane] = ringingFilter.getA2();
+        m_ringingV1[lane] = 0.0f;
+        m_ringingV2[lane] = 0.0f;
+        m_signature[lane] = signature;
+        updateFirstTap();
+    }
+
+    void filterLane(int lane, int from, int n) //!< matched filter of one lane over the rest of the block
+    {
+        for (int i = from; i < n; i++)
+        {
+            float acc = 0.0f;
+
+            for (int t = 0; t < m_maxTaps; t++) {
+                acc += m_coeffs[t][lane] * m_history[i + t][lane];
+            }
+
+            m_filtered[i][lane] = acc;
+        }
+    }
+
+    void clearLane(int lane)
+    {
+        for (int t = 0; t < m_maxTaps; t++) {
+            m_coeffs[t][lane] = 0.0f;
+        }
+
+        m_signature[lane] = 0;
+        m_gain[lane] = 1.0f;
+        m_ringingB0[lane] = 0.0f;
+        m_ringingA1[lane] = 0.0f;
+        m_ringingA2[lane] = 0.0f;
+        m_ringingV1[lane] = 0.0f;
+        m_ringingV2[lane] = 0.0f;
+        updateFirstTap();
+    }
+
+    void updateFirstTap() //!< rows of zero coefficients in all lanes are skipped
+    {
+        for (m_firstTap = 0; m_firstTap < m_maxTaps - 1; m_firstTap++)
+        {
+            bool zero = true;
+
+            for (int lane = 0; lane < N; lane++) {
+                zero = zero && (m_coeffs[m_firstTap][lane] == 0.0f);
+            }
+
+            if (!zero) {
+                break;
+            }
+        }
+    }
+
+    static const int m_blockSize = 64;
+
+    int m_sampleRate;
+    DSDDecoder *m_decoders[N];
+    int m_signature[N];                //!< signature the lane is configured for (see getSignature). 0 if not configured
+    float m_history[m_maxTaps - 1 + m_blockSize][N]; //!< the previous m_maxTaps - 1 samples followed by the block
+    float m_coeffs[m_maxTaps][N];      //!< matched filter of each lane aligned on the newest sample
+    float m_filtered[m_blockSize][N];  //!< matched filter output before gain
+    int m_firstTap;
+    float m_gain[N];
+    float m_ringingB0[N];
+    float m_ringingA1[N];
+    float m_ringingA2[N];
+    float m_ringingV1[N];
+    float m_ringingV2[N];
+    LaneDotKernel m_dot;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_SYMBOLBANK_H_ */
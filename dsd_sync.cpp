@@ -90,52 +90,96 @@ const unsigned int DSDSync::m_syncLenTol[27][2] = {
     {32, 2}, // 26: SyncProVoiceEAInv
 };
 
+// Patterns above packed into 32 bit words: bit n is set in the mask for a significant symbol at index 31-n
+// and set in the value if that symbol is 3
+const uint32_t DSDSync::m_syncWords[27][2] = {
+    {0x00BC64B2, 0x00FFFFFF}, //  0: SyncDMRDataBS
+    {0x00439B4D, 0x00FFFFFF}, //  1: SyncDMRVoiceBS
+    {0x0089D791, 0x00FFFFFF}, //  2: SyncDMRDataMS
+    {0x0076286E, 0x00FFFFFF}, //  3: SyncDMRVoiceMS
+    {0x001F3485, 0x00FFFFFF}, //  4: SyncDPMRFS1
+    {0x00E0CB7A, 0x00FFFFFF}, //  5: SyncDPMRFS4
+    {0x000003D6, 0x00000FFF}, //  6: SyncDPMRFS2
+    {0x000006BC, 0x00000FFF}, //  7: SyncDPMRFS3
+    {0x00053AB2, 0x0007FFFF}, //  8: SyncNXDNRDCHFull
+    {0x0002C54D, 0x0007FFFF}, //  9: SyncNXDNRDCHFullInv
+    {0x000002B2, 0x000003FF}, // 10: SyncNXDNRDCHFSW
+    {0x0000014D, 0x000003FF}, // 11: SyncNXDNRDCHFSWInv
+    {0x00557650, 0x00FFFFFF}, // 12: SyncDStarHeader
+    {0x00AA89AF, 0x00FFFFFF}, // 13: SyncDStarHeaderInv
+    {0x00AAB468, 0x00FFFFFF}, // 14: SyncDStar
+    {0x00554B97, 0x00FFFFFF}, // 15: SyncDStarInv
+    {0x00084A52, 0x000FFFFF}, // 16: SyncYSF
+    {0x0004CF5F, 0x00FFFFFF}, // 17: SyncP25P1
+    {0x00FB30A0, 0x00FFFFFF}, // 18: SyncP25P1Inv
+    {0x00D41473, 0x00FFFFFF}, // 19: SyncX2TDMADataBS
+    {0x002BEB8C, 0x00FFFFFF}, // 20: SyncX2TDMAVoiceBS
+    {0x00A780FD, 0x00FFFFFF}, // 21: SyncX2TDMADataMS
+    {0x00A780FD, 0x00FFFFFF}, // 22: SyncX2TDMAVoiceMS
+    {0x57123333, 0xFFFFFFFF}, // 23: SyncProVoice
+    {0xA8EDCCCC, 0xFFFFFFFF}, // 24: SyncProVoiceInv
+    {0x94D83523, 0xFFFFFFFF}, // 25: SyncProVoiceEA
+    {0x6B27CADC, 0xFFFFFFFF}, // 26: SyncProVoiceEAInv
+};
+
+static inline unsigned int popcount32(uint32_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    return (x * 0x01010101) >> 24;
+#endif
+}
+
 const unsigned char *DSDSync::getPattern(SyncPattern pattern, int& length)
 {
     length = m_syncLenTol[(int) pattern][0];
     return &m_syncPatterns[(int) pattern][m_history - length];
 }
 
+uint64_t DSDSync::pack(const unsigned char *start, int nbSymbols)
+{
+    uint64_t history = 0;
+
+    for (int i = 0; i < nbSymbols; i++) {
+        history = (history << 1) | (start[i] == 3 ? 1 : 0);
+    }
+
+    return history;
+}
+
 void DSDSync::matchAll(const unsigned char *start)
 {
-    std::fill(m_syncErrors, m_syncErrors + m_patterns, 0);
+    matchAll(pack(start, m_history));
+}
 
-    for (int i = 0; i < m_history; i++)
-    {
-        unsigned char c = start[i];
-
-        for (int p = 0; p < m_patterns; p++)
-        {
-            if (m_syncErrors[p] > m_syncLenTol[p][1]) {
-                continue;
-            }
-            if ((m_syncPatterns[p][i] != 0) && (c != m_syncPatterns[p][i])) {
-                m_syncErrors[p]++;
-            }
-        }
+void DSDSync::matchAll(uint64_t history)
+{
+    uint32_t h = (uint32_t) history;
+
+    for (int p = 0; p < m_patterns; p++) {
+        m_syncErrors[p] = popcount32((h ^ m_syncWords[p][0]) & m_syncWords[p][1]);
     }
 }
 
 void DSDSync::matchSome(const unsigned char *start, int maxHistory, const SyncPattern *patterns, int nbPatterns)
+{
+    matchSome(pack(start, maxHistory), maxHistory, patterns, nbPatterns);
+}
+
+void DSDSync::matchSome(uint64_t history, int maxHistory, const SyncPattern *patterns, int nbPatterns)
 {
     std::fill(m_syncErrors, m_syncErrors + m_patterns, 0);
-    int pshift = m_history - maxHistory;
+    uint32_t h = (uint32_t) history;
+    uint32_t historyMask = maxHistory < m_history ? (1U << maxHistory) - 1 : 0xFFFFFFFF;
 
-    for (int i = 0; i < maxHistory; i++)
+    for (int ip = 0; ip < nbPatterns; ip++)
     {
-        unsigned char c = start[i];
-
-        for (int ip = 0; ip < nbPatterns; ip++)
-        {
-            int p = (int) patterns[ip];
-
-            if (m_syncErrors[p] > m_syncLenTol[p][1]) {
-                continue;
-            }
-            if ((m_syncPatterns[p][i+pshift] != 0) && (c != m_syncPatterns[p][i+pshift])) {
-                m_syncErrors[p]++;
-            }
-        }
+        int p = (int) patterns[ip];
+        m_syncErrors[p] = popcount32((h ^ m_syncWords[p][0]) & m_syncWords[p][1] & historyMask);
     }
 }
 
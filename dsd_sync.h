@@ -17,6 +17,7 @@
 #ifndef DSD_SYNC_H_
 #define DSD_SYNC_H_
 
+#include <stdint.h>
 #include "export.h"
 
 namespace DSDcc
@@ -60,11 +61,15 @@ public:
     static const int m_patterns = 27;
     static const unsigned char m_syncPatterns[m_patterns][m_history]; //!< Patterns
     static const unsigned int m_syncLenTol[m_patterns][2];            //!< Length (0) and tolerance (1)
+    static const uint32_t m_syncWords[m_patterns][2];                 //!< Patterns packed as value (0) and mask (1) words. Most recent symbol is LSB, bit set for symbol 3
     unsigned int m_syncErrors[m_patterns];
 
     static const unsigned char *getPattern(SyncPattern pattern, int& length);
     void matchAll(const unsigned char *start);
+    void matchAll(uint64_t history); //!< history is a shift register with the most recent symbol in LSB and a bit set for symbol 3
     void matchSome(const unsigned char *start, int maxHistory, const SyncPattern *patterns, int nbPatterns);
+    void matchSome(uint64_t history, int maxHistory, const SyncPattern *patterns, int nbPatterns);
+    static uint64_t pack(const unsigned char *start, int nbSymbols); //!< pack a symbol array (1 or 3) into a history word
     bool isMatching(SyncPattern pattern);
     unsigned int getErrors(SyncPattern pattern);
 };
@@ -0,0 +1,290 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <string>
+
+#include "dsd_decoder.h"
+#include "dsd_framerecorder.h"
+
+/**
+ * Synthesizes vocoder frame recordings made with dsdccx --record to S16LE audio files. Each recording is
+ * synthesized by a decoder of its own and the recordings are shared among worker threads.
+ */
+struct SynthOptions
+{
+    SynthOptions() :
+        m_upsampling(0),
+        m_audioRate(0),
+        m_gain(0.0f),
+        m_gainSet(false),
+        m_useHP(false),
+        m_slots(1),
+        m_messages(false)
+    {}
+
+    int m_upsampling;
+    int m_audioRate;
+    float m_gain;
+    bool m_gainSet;
+    bool m_useHP;
+    int m_slots;
+    bool m_messages; //!< write the call information of each recording to a text file
+};
+
+/**
+ * Audio of the frames of the selected slots written as they come
+ */
+class FileWriter : public DSDcc::DSDAudioSink
+{
+public:
+    FileWriter(FILE *fp, int slots) : m_fp(fp), m_slots(slots), m_nbSamples(0) {}
+    virtual void audioFrame(int slot, const short *samples, int nbSamples, uint64_t timestamp);
+    uint64_t getNbSamples() const { return m_nbSamples; }
+
+private:
+    FILE *m_fp;
+    int m_slots;
+    uint64_t m_nbSamples;
+};
+
+void FileWriter::audioFrame(int slot, const short *samples, int nbSamples, uint64_t)
+{
+    if (((m_slots >> slot) & 1) == 0) {
+        return;
+    }
+
+    m_nbSamples += fwrite(samples, sizeof(short), nbSamples, m_fp);
+}
+
+/**
+ * The decoders write to the standard streams redirected by DSDLogger when they are constructed and
+ * destroyed. This is not thread safe.
+ */
+static std::mutex decoderMutex;
+
+static bool synthesizeFile(const std::string& inFile, const SynthOptions& options)
+{
+    DSDcc::DSDFrameReader reader;
+
+    if (!reader.open(inFile.c_str()))
+    {
+        fprintf(stderr, "%s: not a vocoder frame recording\n", inFile.c_str());
+        return false;
+    }
+
+    std::string outFile = inFile + ".raw";
+    FILE *outFp = fopen(outFile.c_str(), "wb");
+
+    if (!outFp)
+    {
+        fprintf(stderr, "%s: cannot open %s for output\n", inFile.c_str(), outFile.c_str());
+        return false;
+    }
+
+    FILE *msgFp = 0;
+
+    if (options.m_messages) {
+        msgFp = fopen((inFile + ".msg").c_str(), "w");
+    }
+
+    DSDcc::DSDDecoder *dsdDecoder;
+
+    {
+        std::lock_guard<std::mutex> lock(decoderMutex);
+        dsdDecoder = new DSDcc::DSDDecoder();
+    }
+
+    FileWriter fileWriter(outFp, options.m_slots);
+    dsdDecoder->setAudioSink(&fileWriter);
+    dsdDecoder->setUpsampling(options.m_upsampling);
+    dsdDecoder->setAudioRate(options.m_audioRate);
+    dsdDecoder->useHPMbelib(options.m_useHP);
+
+    if (options.m_gainSet) {
+        dsdDecoder->setAudioGain(options.m_gain);
+    }
+
+    DSDcc::DSDFrameRecord record;
+    uint64_t sessionTime = 0;      // epoch in ms at the start of the session
+    uint64_t sessionTimestamp = 0; // decoder sample count at the start of the session
+    int inputRate = 48000;
+    unsigned int nbFrames = 0;
+
+    while (reader.next(record))
+    {
+        switch (record.m_type)
+        {
+        case DSDcc::DSDFrameRecord::RecordSession:
+            sessionTime = record.m_time;
+            sessionTimestamp = record.m_timestamp;
+            inputRate = record.m_inputRate > 0 ? record.m_inputRate : 48000;
+            dsdDecoder->synthesizeRecord(record);
+            break;
+        case DSDcc::DSDFrameRecord::RecordCallInfo:
+            if (msgFp && (((options.m_slots >> record.m_slot) & 1) != 0))
+            {
+                uint64_t ms = sessionTime + ((record.m_timestamp - sessionTimestamp) * 1000) / inputRate;
+                fprintf(msgFp, "%u.%03u:%s\n", (uint32_t) (ms / 1000), (uint32_t) (ms % 1000), record.m_text);
+            }
+            break;
+        case DSDcc::DSDFrameRecord::RecordFrame:
+        case DSDcc::DSDFrameRecord::RecordData:
+            nbFrames++;
+            dsdDecoder->synthesizeRecord(record);
+            break;
+        default:
+            dsdDecoder->synthesizeRecord(record);
+            break;
+        }
+    }
+
+    if (reader.isCorrupted()) {
+        fprintf(stderr, "%s: truncated or corrupted after %u frames\n", inFile.c_str(), nbFrames);
+    }
+
+    fprintf(stderr, "%s: %u frames to %llu samples in %s\n", inFile.c_str(), nbFrames, (unsigned long long) fileWriter.getNbSamples(), outFile.c_str());
+
+    {
+        std::lock_guard<std::mutex> lock(decoderMutex);
+        delete dsdDecoder;
+    }
+
+    if (msgFp) {
+        fclose(msgFp);
+    }
+
+    fclose(outFp);
+    return true;
+}
+
+static void worker(const std::vector<std::string> *inFiles, const SynthOptions *options, std::atomic<unsigned int> *nextFile, std::atomic<unsigned int> *nbFailed)
+{
+    unsigned int i;
+
+    while ((i = nextFile->fetch_add(1)) < inFiles->size())
+    {
+        if (!synthesizeFile((*inFiles)[i], *options)) {
+            nbFailed->fetch_add(1);
+        }
+    }
+}
+
+static void usage()
+{
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  dsdccsynth [options] <recording> [<recording>...]\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Synthesizes vocoder frame recordings made with dsdccx --record. The audio of <recording> is\n");
+    fprintf(stderr, "written as S16LE samples to <recording>.raw\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -h            Show help\n");
+    fprintf(stderr, "  -j <num>      Number of recordings synthesized in parallel (default number of cores)\n");
+    fprintf(stderr, "  -T <num>      TDMA slots written: 1 slot #1 (default), 2 slot #2, 3 both one frame after the other\n");
+    fprintf(stderr, "  -g <num>      Audio output gain (default = 0 = auto, disable = -1)\n");
+    fprintf(stderr, "  -U <num>      Audio output upsampling (0: 8k default, 6: 48k, 7: 56k)\n");
+    fprintf(stderr, "  --audio-rate <num> Audio output rate in S/s through the polyphase resampler instead of -U upsampling (at most 56000)\n");
+    fprintf(stderr, "  -H            Use high-pass filter on audio\n");
+    fprintf(stderr, "  -M            Write the call information with its time to <recording>.msg\n");
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+    int c;
+    SynthOptions options;
+    unsigned int nbThreads = std::thread::hardware_concurrency();
+
+    static const struct option longOptions[] = {
+        {"audio-rate", required_argument, 0, 'A'},
+        {0, 0, 0, 0}
+    };
+
+    while ((c = getopt_long(argc, argv, "hj:T:g:U:HM", longOptions, 0)) != -1)
+    {
+        switch (c)
+        {
+        case 'j':
+            sscanf(optarg, "%u", &nbThreads);
+            break;
+        case 'T':
+            sscanf(optarg, "%d", &options.m_slots);
+            options.m_slots &= 3;
+            break;
+        case 'g':
+            sscanf(optarg, "%f", &options.m_gain);
+            options.m_gainSet = true;
+            break;
+        case 'U':
+            sscanf(optarg, "%d", &options.m_upsampling);
+            break;
+        case 'A':
+            sscanf(optarg, "%d", &options.m_audioRate);
+            if (!DSDcc::DSDDecoder::isAudioRateSupported(options.m_audioRate))
+            {
+                fprintf(stderr, "Audio rate %d S/s is not supported. Aborting\n", options.m_audioRate);
+                return 1;
+            }
+            break;
+        case 'H':
+            options.m_useHP = true;
+            break;
+        case 'M':
+            options.m_messages = true;
+            break;
+        case 'h':
+        default:
+            usage();
+            return 0;
+        }
+    }
+
+    std::vector<std::string> inFiles(argv + optind, argv + argc);
+
+    if (inFiles.empty())
+    {
+        usage();
+        return 0;
+    }
+
+    if ((nbThreads == 0) || (nbThreads > inFiles.size())) {
+        nbThreads = nbThreads == 0 ? 1 : inFiles.size();
+    }
+
+    std::atomic<unsigned int> nextFile(0);
+    std::atomic<unsigned int> nbFailed(0);
+    std::vector<std::thread> threads;
+
+    for (unsigned int i = 1; i < nbThreads; i++) {
+        threads.push_back(std::thread(worker, &inFiles, &options, &nextFile, &nbFailed));
+    }
+
+    worker(&inFiles, &options, &nextFile, &nbFailed); // this thread takes its share
+
+    for (unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    return nbFailed.load() == 0 ? 0 : 1;
+}
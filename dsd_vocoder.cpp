@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "dsd_vocoder.h"
+#include "dsd_mbe.h"
+
+namespace DSDcc
+{
+
+DSDVocoder::DSDVocoder(DSDMBEDecoder *mbeDecoder1, DSDMBEDecoder *mbeDecoder2, bool waitWhenFull) :
+        m_waitWhenFull(waitWhenFull),
+        m_head(0),
+        m_tail(0),
+        m_dropped(0),
+        m_waiting(false),
+        m_stop(false)
+{
+    m_mbeDecoders[0] = mbeDecoder1;
+    m_mbeDecoders[1] = mbeDecoder2;
+    m_thread = std::thread(workerLoop, this);
+}
+
+DSDVocoder::~DSDVocoder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop.store(true);
+        m_jobCond.notify_one();
+    }
+
+    m_thread.join();
+}
+
+DSDVocoder::Job *DSDVocoder::reserve()
+{
+    unsigned int tail = m_tail.load(std::memory_order_relaxed);
+
+    if (tail - m_head.load(std::memory_order_acquire) >= m_ringSize)
+    {
+        if (m_waitWhenFull)
+        {
+            flush(); // the worker has a full ring to synthesize so waiting for all of it costs nothing
+            return &m_ring[tail & (m_ringSize - 1)];
+        }
+
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    return &m_ring[tail & (m_ringSize - 1)];
+}
+
+void DSDVocoder::publish()
+{
+    // sequentially consistent store and load pair with the worker's m_waiting store and m_tail load
+    // so that either the worker sees the job or this sees the worker waiting
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1);
+
+    if (m_waiting.load())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobCond.notify_one();
+    }
+}
+
+void DSDVocoder::postFrame(int slot, uint64_t timestamp, DSDDecoder::DSDMBERate mbeRate, int uvquality, char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24])
+{
+    Job *job = reserve();
+
+    if (!job) {
+        return;
+    }
+
+    job->m_type = Job::JobFrame;
+    job->m_slot = slot;
+    job->m_timestamp = timestamp;
+    job->m_mbeRate = mbeRate;
+    job->m_uvquality = uvquality;
+
+    if (imbe_fr) { // the frame decoders pass only the frame of the rate they use
+        memcpy(job->m_imbe_fr, imbe_fr, sizeof(job->m_imbe_fr));
+    }
+
+    if (ambe_fr) {
+        memcpy(job->m_ambe_fr, ambe_fr, sizeof(job->m_ambe_fr));
+    }
+
+    if (imbe7100_fr) {
+        memcpy(job->m_imbe7100_fr, imbe7100_fr, sizeof(job->m_imbe7100_fr));
+    }
+
+    publish();
+}
+
+void DSDVocoder::postData(int slot, uint64_t timestamp, DSDDecoder::DSDMBERate mbeRate, int uvquality, char imbe_data[88], char ambe_data[49])
+{
+    Job *job = reserve();
+
+    if (!job) {
+        return;
+    }
+
+    job->m_type = Job::JobData;
+    job->m_slot = slot;
+    job->m_timestamp = timestamp;
+    job->m_mbeRate = mbeRate;
+    job->m_uvquality = uvquality;
+
+    if (imbe_data) { // the frame decoders pass only the frame of the rate they use
+        memcpy(job->m_imbe_data, imbe_data, sizeof(job->m_imbe_data));
+    }
+
+    if (ambe_data) {
+        memcpy(job->m_ambe_data, ambe_data, sizeof(job->m_ambe_data));
+    }
+
+    publish();
+}
+
+void DSDVocoder::postInit(int slot)
+{
+    Job *job = reserve();
+
+    if (!job) {
+        return;
+    }
+
+    job->m_type = Job::JobInit;
+    job->m_slot = slot;
+    publish();
+}
+
+void DSDVocoder::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCond.wait(lock, [this] { return m_head.load() == m_tail.load(); });
+}
+
+void DSDVocoder::run(Job& job)
+{
+    DSDMBEDecoder *mbeDecoder = m_mbeDecoders[job.m_slot];
+
+    switch (job.m_type)
+    {
+    case Job::JobFrame:
+        mbeDecoder->m_timestamp = job.m_timestamp;
+        mbeDecoder->synthesizeFrame(job.m_mbeRate, job.m_uvquality, job.m_imbe_fr, job.m_ambe_fr, job.m_imbe7100_fr);
+        break;
+    case Job::JobData:
+        mbeDecoder->m_timestamp = job.m_timestamp;
+        mbeDecoder->synthesizeData(job.m_mbeRate, job.m_uvquality, job.m_imbe_data, job.m_ambe_data);
+        break;
+    case Job::JobInit:
+    default:
+        mbeDecoder->initSynthesis();
+        break;
+    }
+}
+
+void DSDVocoder::workerLoop(DSDVocoder *vocoder)
+{
+    while (true)
+    {
+        unsigned int head = vocoder->m_head.load(std::memory_order_relaxed);
+
+        if (head != vocoder->m_tail.load(std::memory_order_acquire))
+        {
+            vocoder->run(vocoder->m_ring[head & (m_ringSize - 1)]);
+            vocoder->m_head.store(head + 1, std::memory_order_release);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(vocoder->m_mutex);
+        vocoder->m_doneCond.notify_all();
+
+        if (vocoder->m_stop.load()) {
+            break;
+        }
+
+        vocoder->m_waiting.store(true);
+        vocoder->m_jobCond.wait(lock, [vocoder, head] {
+            return vocoder->m_stop.load() || (vocoder->m_tail.load() != head);
+        });
+        vocoder->m_waiting.store(false);
+    }
+}
+
+} // namespace DSDcc
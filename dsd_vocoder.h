@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_VOCODER_H_
+#define DSDCC_DSD_VOCODER_H_
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "dsd_decoder.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+class DSDMBEDecoder;
+
+/**
+ * Runs the AMBE/IMBE synthesis of the two MBE decoders of a DSDDecoder on a thread of its own so that
+ * the symbol thread only extracts frames.
+ *
+ * Frames are posted with their slot, their timestamp and the MBE rate and unvoiced quality in force when
+ * they were extracted on a single producer single consumer ring. The worker synthesizes them in posting
+ * order and the MBE decoders hand the audio of each frame to the decoder's audio sink. A frame posted to a full ring is dropped and
+ * counted rather than stalling the symbol thread, unless waiting when full was asked for as when
+ * decoding a file faster than real time.
+ *
+ * Frames are posted by the thread running the decoder. The audio settings of the MBE decoders (gain,
+ * upsampling, stereo...) are read by the worker and should not be changed while it runs.
+ */
+class DSDCC_API DSDVocoder
+{
+public:
+    DSDVocoder(DSDMBEDecoder *mbeDecoder1, DSDMBEDecoder *mbeDecoder2, bool waitWhenFull);
+    ~DSDVocoder(); //!< synthesizes pending frames before returning
+
+    void postFrame(int slot, uint64_t timestamp, DSDDecoder::DSDMBERate mbeRate, int uvquality, char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24]);
+    void postData(int slot, uint64_t timestamp, DSDDecoder::DSDMBERate mbeRate, int uvquality, char imbe_data[88], char ambe_data[49]);
+    void postInit(int slot); //!< reset of the MBE parameters and gain in sequence with the frames
+    void flush();            //!< returns when all frames posted so far have been synthesized
+    unsigned int getDroppedFrames() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Job
+    {
+        enum Type
+        {
+            JobFrame,
+            JobData,
+            JobInit
+        };
+
+        Type m_type;
+        int m_slot;
+        uint64_t m_timestamp;
+        DSDDecoder::DSDMBERate m_mbeRate;
+        int m_uvquality;
+        char m_imbe_fr[8][23];
+        char m_ambe_fr[4][24];
+        char m_imbe7100_fr[7][24];
+        char m_imbe_data[88];
+        char m_ambe_data[49];
+    };
+
+    Job *reserve();  //!< next free slot of the ring or 0 if full and not waiting
+    void publish();
+    void run(Job& job);
+    static void workerLoop(DSDVocoder *vocoder);
+
+    static const unsigned int m_ringSize = 64; //!< power of two. 1.28s of a slot at 20ms per frame
+
+    DSDMBEDecoder *m_mbeDecoders[2];
+    bool m_waitWhenFull;
+    Job m_ring[m_ringSize];
+    std::atomic<unsigned int> m_head; //!< next job to synthesize. Written by the worker
+    std::atomic<unsigned int> m_tail; //!< next job to post. Written by the producer
+    std::atomic<unsigned int> m_dropped;
+    std::atomic<bool> m_waiting;      //!< worker about to wait or waiting for a job
+    std::atomic<bool> m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_jobCond;
+    std::condition_variable m_doneCond;
+    std::thread m_thread;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_VOCODER_H_ */
@@ -460,7 +460,7 @@ void DSDDstar::processSync()
     {
         DSDSync syncEngine;
         const DSDSync::SyncPattern patterns[1] = { DSDSync::SyncDStar };
-        syncEngine.matchSome(m_dsdDecoder->m_dsdSymbol.getNonInvertedSyncDibitBack(24), 24, patterns, 1);
+        syncEngine.matchSome(m_dsdDecoder->m_dsdSymbol.getNonInvertedSyncHistory(), 24, patterns, 1);
 
         if (syncEngine.isMatching(DSDSync::SyncDStar)) // sync
         {
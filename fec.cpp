@@ -21,6 +21,75 @@
 namespace DSDcc
 {
 
+// Packed codeword helpers. Bit 0 of a bit array maps to the MSB of the packed word.
+
+static inline unsigned int fecPopcount(uint32_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    return (x * 0x01010101) >> 24;
+#endif
+}
+
+static inline uint32_t fecPack(const unsigned char *bits, int n)
+{
+    uint32_t word = 0;
+
+    for (int i = 0; i < n; i++) {
+        word = (word << 1) | (bits[i] & 1);
+    }
+
+    return word;
+}
+
+static inline void fecUnpack(uint32_t word, unsigned char *bits, int n)
+{
+    for (int i = 0; i < n; i++) {
+        bits[i] = (word >> (n-1-i)) & 1;
+    }
+}
+
+static inline unsigned int fecSyndrome(uint32_t codeword, const uint32_t *hMasks, int nbRows)
+{
+    unsigned int syndromeI = 0;
+
+    for (int ir = 0; ir < nbRows; ir++) {
+        syndromeI = (syndromeI << 1) | (fecPopcount(codeword & hMasks[ir]) & 1);
+    }
+
+    return syndromeI;
+}
+
+static void fecBuildHMasks(const unsigned char *H, int n, int nbRows, uint32_t *hMasks)
+{
+    for (int ir = 0; ir < nbRows; ir++) {
+        hMasks[ir] = fecPack(&H[n*ir], n);
+    }
+}
+
+static void fecBuildCorrMasks(const unsigned char *corr, int nbSyndromes, int nbCorr, int n, uint32_t *corrMasks)
+{
+    for (int is = 0; is < nbSyndromes; is++)
+    {
+        corrMasks[is] = 0;
+
+        for (int i = 0; i < nbCorr; i++)
+        {
+            unsigned char x = corr[nbCorr*is + i];
+
+            if (x >= n) { // 0xFF terminates the list
+                break;
+            }
+
+            corrMasks[is] |= 1U << (n-1-x);
+        }
+    }
+}
+
 const unsigned char Hamming_7_4::m_G[7*4] = {
         1, 0, 0, 0,   1, 0, 1,
         0, 1, 0, 0,   1, 1, 1,
@@ -221,9 +290,17 @@ const unsigned char QR_16_7_6::m_H[16*9] = {
 
 // ========================================================================================
 
+// Correction tables are shared by all instances of a class and built once on first construction.
+// The function local static guarding init() gives thread safe one time initialization (C++11).
+
+uint32_t Hamming_7_4::m_hMasks[3];
+uint32_t Hamming_7_4::m_corrMasks[8];
+unsigned char Hamming_7_4::m_corr[8];
+
 Hamming_7_4::Hamming_7_4()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Hamming_7_4::~Hamming_7_4()
@@ -241,6 +318,9 @@ void Hamming_7_4::init()
     m_corr[0b100] = 4;
     m_corr[0b010] = 5;
     m_corr[0b001] = 6;
+
+    fecBuildHMasks(m_H, 7, 3, m_hMasks);
+    fecBuildCorrMasks(m_corr, 8, 1, 7, m_corrMasks);
 }
 
 // Not very efficient but encode is used for unit testing only
@@ -264,39 +344,47 @@ void Hamming_7_4::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Hamming_7_4::decode(unsigned char *rxBits) // corrects in place
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = fecPack(rxBits, 7);
+    uint32_t data;
+    int nbErrors;
+    bool correctable = decode(codeword, data, nbErrors);
+    fecUnpack(codeword, rxBits, 7);
+    return correctable;
+}
 
-    for (int is = 0; is < 3; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[7*is + 0])
-                    + (rxBits[1] * m_H[7*is + 1])
-                    + (rxBits[2] * m_H[7*is + 2])
-                    + (rxBits[3] * m_H[7*is + 3])
-                    + (rxBits[4] * m_H[7*is + 4])
-                    + (rxBits[5] * m_H[7*is + 5])
-                    + (rxBits[6] * m_H[7*is + 6])) % 2) << (2-is);
-    }
+bool Hamming_7_4::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 3);
+    bool correctable = true;
+    nbErrors = 0;
 
     if (syndromeI > 0)
     {
-        if (m_corr[syndromeI] == 0xFF)
+        if (m_corrMasks[syndromeI] == 0)
         {
-            return false;
+            correctable = false;
         }
         else
         {
-            rxBits[m_corr[syndromeI]] ^= 1; // flip bit
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
         }
     }
 
-    return true;
+    data = codeword >> 3;
+    return correctable;
 }
 
 // ========================================================================================
 
+uint32_t Hamming_12_8::m_hMasks[4];
+uint32_t Hamming_12_8::m_corrMasks[16];
+unsigned char Hamming_12_8::m_corr[16];
+
 Hamming_12_8::Hamming_12_8()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Hamming_12_8::~Hamming_12_8()
@@ -319,6 +407,9 @@ void Hamming_12_8::init()
     m_corr[0b0100] = 9;
     m_corr[0b0010] = 10;
     m_corr[0b0001] = 11;
+
+    fecBuildHMasks(m_H, 12, 4, m_hMasks);
+    fecBuildCorrMasks(m_corr, 16, 1, 12, m_corrMasks);
 }
 
 // Not very efficient but encode is used for unit testing only
@@ -343,42 +434,19 @@ void Hamming_12_8::encode(unsigned char *origBits, unsigned char *encodedBits)
 bool Hamming_12_8::decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords)
 {
     bool correctable = true;
+    uint32_t data;
+    int nbErrors;
 
     for (int ic = 0; ic < nbCodewords; ic++)
     {
-        // calculate syndrome
+        uint32_t codeword = fecPack(&rxBits[12*ic], 12);
 
-        int syndromeI = 0; // syndrome index
-
-        for (int is = 0; is < 4; is++)
+        if (!decode(codeword, data, nbErrors)) // uncorrectable error
         {
-            syndromeI += (((rxBits[12*ic +  0] * m_H[12*is +  0])
-                         + (rxBits[12*ic +  1] * m_H[12*is +  1])
-                         + (rxBits[12*ic +  2] * m_H[12*is +  2])
-                         + (rxBits[12*ic +  3] * m_H[12*is +  3])
-                         + (rxBits[12*ic +  4] * m_H[12*is +  4])
-                         + (rxBits[12*ic +  5] * m_H[12*is +  5])
-                         + (rxBits[12*ic +  6] * m_H[12*is +  6])
-                         + (rxBits[12*ic +  7] * m_H[12*is +  7])
-                         + (rxBits[12*ic +  8] * m_H[12*is +  8])
-                         + (rxBits[12*ic +  9] * m_H[12*is +  9])
-                         + (rxBits[12*ic + 10] * m_H[12*is + 10])
-                         + (rxBits[12*ic + 11] * m_H[12*is + 11])) % 2) << (3-is);
+            correctable = false;
         }
 
-        // correct bit
-
-        if (syndromeI > 0) // single bit error correction
-        {
-            if (m_corr[syndromeI] == 0xFF) // uncorrectable error
-            {
-                correctable = false;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI]] ^= 1; // flip bit
-            }
-        }
+        fecUnpack(codeword, &rxBits[12*ic], 12);
 
         // move information bits
         memcpy(&decodedBits[8*ic], &rxBits[12*ic], 8);
@@ -387,11 +455,39 @@ bool Hamming_12_8::decode(unsigned char *rxBits, unsigned char *decodedBits, int
     return correctable;
 }
 
+bool Hamming_12_8::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 4);
+    bool correctable = true;
+    nbErrors = 0;
+
+    if (syndromeI > 0)
+    {
+        if (m_corrMasks[syndromeI] == 0)
+        {
+            correctable = false;
+        }
+        else
+        {
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
+        }
+    }
+
+    data = codeword >> 4;
+    return correctable;
+}
+
 // ========================================================================================
 
+uint32_t Hamming_16_11_4::m_hMasks[5];
+uint32_t Hamming_16_11_4::m_corrMasks[32];
+unsigned char Hamming_16_11_4::m_corr[32];
+
 Hamming_16_11_4::Hamming_16_11_4()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Hamming_16_11_4::~Hamming_16_11_4()
@@ -418,6 +514,9 @@ void Hamming_16_11_4::init()
     m_corr[0b00100] = 13;
     m_corr[0b00010] = 14;
     m_corr[0b00001] = 15;
+
+    fecBuildHMasks(m_H, 16, 5, m_hMasks);
+    fecBuildCorrMasks(m_corr, 32, 1, 16, m_corrMasks);
 }
 
 // Not very efficient but encode is used for unit testing only
@@ -442,47 +541,20 @@ void Hamming_16_11_4::encode(unsigned char *origBits, unsigned char *encodedBits
 bool Hamming_16_11_4::decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords)
 {
     bool correctable = true;
+    uint32_t data;
+    int nbErrors;
 
     for (int ic = 0; ic < nbCodewords; ic++)
     {
-        // calculate syndrome
-
-        int syndromeI = 0; // syndrome index
+        uint32_t codeword = fecPack(&rxBits[16*ic], 16);
 
-        for (int is = 0; is < 5; is++)
+        if (!decode(codeword, data, nbErrors)) // uncorrectable error
         {
-            syndromeI += (((rxBits[16*ic +  0] * m_H[16*is +  0])
-                         + (rxBits[16*ic +  1] * m_H[16*is +  1])
-                         + (rxBits[16*ic +  2] * m_H[16*is +  2])
-                         + (rxBits[16*ic +  3] * m_H[16*is +  3])
-                         + (rxBits[16*ic +  4] * m_H[16*is +  4])
-                         + (rxBits[16*ic +  5] * m_H[16*is +  5])
-                         + (rxBits[16*ic +  6] * m_H[16*is +  6])
-                         + (rxBits[16*ic +  7] * m_H[16*is +  7])
-                         + (rxBits[16*ic +  8] * m_H[16*is +  8])
-                         + (rxBits[16*ic +  9] * m_H[16*is +  9])
-                         + (rxBits[16*ic + 10] * m_H[16*is + 10])
-                         + (rxBits[16*ic + 11] * m_H[16*is + 11])
-                         + (rxBits[16*ic + 12] * m_H[16*is + 12])
-                         + (rxBits[16*ic + 13] * m_H[16*is + 13])
-                         + (rxBits[16*ic + 14] * m_H[16*is + 14])
-                         + (rxBits[16*ic + 15] * m_H[16*is + 15])) % 2) << (4-is);
+            correctable = false;
+            break;
         }
 
-        // correct bit
-
-        if (syndromeI > 0) // single bit error correction
-        {
-            if (m_corr[syndromeI] == 0xFF) // uncorrectable error
-            {
-                correctable = false;
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI]] ^= 1; // flip bit
-            }
-        }
+        fecUnpack(codeword, &rxBits[16*ic], 16);
 
         // move information bits
         if (decodedBits)
@@ -494,11 +566,39 @@ bool Hamming_16_11_4::decode(unsigned char *rxBits, unsigned char *decodedBits,
     return correctable;
 }
 
+bool Hamming_16_11_4::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 5);
+    bool correctable = true;
+    nbErrors = 0;
+
+    if (syndromeI > 0)
+    {
+        if (m_corrMasks[syndromeI] == 0)
+        {
+            correctable = false;
+        }
+        else
+        {
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
+        }
+    }
+
+    data = codeword >> 5;
+    return correctable;
+}
+
 // ========================================================================================
 
+uint32_t Hamming_15_11::m_hMasks[4];
+uint32_t Hamming_15_11::m_corrMasks[16];
+unsigned char Hamming_15_11::m_corr[16];
+
 Hamming_15_11::Hamming_15_11()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Hamming_15_11::~Hamming_15_11()
@@ -524,6 +624,9 @@ void Hamming_15_11::init()
     m_corr[0b0100] = 12;
     m_corr[0b0010] = 13;
     m_corr[0b0001] = 14;
+
+    fecBuildHMasks(m_H, 15, 4, m_hMasks);
+    fecBuildCorrMasks(m_corr, 16, 1, 15, m_corrMasks);
 }
 
 // Not very efficient but encode is used for unit testing only
@@ -548,46 +651,20 @@ void Hamming_15_11::encode(unsigned char *origBits, unsigned char *encodedBits)
 bool Hamming_15_11::decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords)
 {
     bool correctable = true;
+    uint32_t data;
+    int nbErrors;
 
     for (int ic = 0; ic < nbCodewords; ic++)
     {
-        // calculate syndrome
-
-        int syndromeI = 0; // syndrome index
+        uint32_t codeword = fecPack(&rxBits[15*ic], 15);
 
-        for (int is = 0; is < 4; is++)
+        if (!decode(codeword, data, nbErrors)) // uncorrectable error
         {
-            syndromeI += (((rxBits[15*ic +  0] * m_H[15*is +  0])
-                         + (rxBits[15*ic +  1] * m_H[15*is +  1])
-                         + (rxBits[15*ic +  2] * m_H[15*is +  2])
-                         + (rxBits[15*ic +  3] * m_H[15*is +  3])
-                         + (rxBits[15*ic +  4] * m_H[15*is +  4])
-                         + (rxBits[15*ic +  5] * m_H[15*is +  5])
-                         + (rxBits[15*ic +  6] * m_H[15*is +  6])
-                         + (rxBits[15*ic +  7] * m_H[15*is +  7])
-                         + (rxBits[15*ic +  8] * m_H[15*is +  8])
-                         + (rxBits[15*ic +  9] * m_H[15*is +  9])
-                         + (rxBits[15*ic + 10] * m_H[15*is + 10])
-                         + (rxBits[15*ic + 11] * m_H[15*is + 11])
-                         + (rxBits[15*ic + 12] * m_H[15*is + 12])
-                         + (rxBits[15*ic + 13] * m_H[15*is + 13])
-                         + (rxBits[15*ic + 14] * m_H[15*is + 14])) % 2) << (3-is);
+            correctable = false;
+            break;
         }
 
-        // correct bit
-
-        if (syndromeI > 0) // single bit error correction
-        {
-            if (m_corr[syndromeI] == 0xFF) // uncorrectable error
-            {
-                correctable = false;
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI]] ^= 1; // flip bit
-            }
-        }
+        fecUnpack(codeword, &rxBits[15*ic], 15);
 
         // move information bits
         if (decodedBits)
@@ -599,11 +676,39 @@ bool Hamming_15_11::decode(unsigned char *rxBits, unsigned char *decodedBits, in
     return correctable;
 }
 
+bool Hamming_15_11::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 4);
+    bool correctable = true;
+    nbErrors = 0;
+
+    if (syndromeI > 0)
+    {
+        if (m_corrMasks[syndromeI] == 0)
+        {
+            correctable = false;
+        }
+        else
+        {
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
+        }
+    }
+
+    data = codeword >> 4;
+    return correctable;
+}
+
 // ========================================================================================
 
+uint32_t Golay_20_8::m_hMasks[12];
+uint32_t Golay_20_8::m_corrMasks[4096];
+unsigned char Golay_20_8::m_corr[4096][3];
+
 Golay_20_8::Golay_20_8()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Golay_20_8::~Golay_20_8()
@@ -702,6 +807,9 @@ void Golay_20_8::init()
             }
         }
     }
+
+    fecBuildHMasks(m_H, 20, 12, m_hMasks);
+    fecBuildCorrMasks(&m_corr[0][0], 4096, 3, 20, m_corrMasks);
 }
 
 // Not very efficient but encode is used for unit testing only
@@ -725,67 +833,47 @@ void Golay_20_8::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Golay_20_8::decode(unsigned char *rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = fecPack(rxBits, 20);
+    uint32_t data;
+    int nbErrors;
+    bool correctable = decode(codeword, data, nbErrors);
+    fecUnpack(codeword, rxBits, 20);
+    return correctable;
+}
 
-    for (int is = 0; is < 12; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[20*is + 0])
-                    + (rxBits[1] * m_H[20*is + 1])
-                    + (rxBits[2] * m_H[20*is + 2])
-                    + (rxBits[3] * m_H[20*is + 3])
-                    + (rxBits[4] * m_H[20*is + 4])
-                    + (rxBits[5] * m_H[20*is + 5])
-                    + (rxBits[6] * m_H[20*is + 6])
-                    + (rxBits[7] * m_H[20*is + 7])
-                    + (rxBits[8] * m_H[20*is + 8])
-                    + (rxBits[9] * m_H[20*is + 9])
-                    + (rxBits[10] * m_H[20*is + 10])
-                    + (rxBits[11] * m_H[20*is + 11])
-                    + (rxBits[12] * m_H[20*is + 12])
-                    + (rxBits[13] * m_H[20*is + 13])
-                    + (rxBits[14] * m_H[20*is + 14])
-                    + (rxBits[15] * m_H[20*is + 15])
-                    + (rxBits[16] * m_H[20*is + 16])
-                    + (rxBits[17] * m_H[20*is + 17])
-                    + (rxBits[18] * m_H[20*is + 18])
-                    + (rxBits[19] * m_H[20*is + 19])) % 2) << (11-is);
-    }
+bool Golay_20_8::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 12);
+    bool correctable = true;
+    nbErrors = 0;
 
     if (syndromeI > 0)
     {
-        int i = 0;
-
-        for (; i < 3; i++)
+        if (m_corrMasks[syndromeI] == 0)
         {
-            if (m_corr[syndromeI][i] == 0xFF)
-            {
-                break;
-            }
-            else
-            {
-                int x = m_corr[syndromeI][i];
-                if (x > 19) {
-                    TRACE("ECC: %d\r\n", x);
-                }
-                else
-                    rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
-            }
+            correctable = false;
         }
-
-        if (i == 0)
+        else
         {
-            return false;
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
         }
     }
 
-    return true;
+    data = codeword >> 12;
+    return correctable;
 }
 
 // ========================================================================================
 
+uint32_t Golay_23_12::m_hMasks[11];
+uint32_t Golay_23_12::m_corrMasks[2048];
+unsigned char Golay_23_12::m_corr[2048][3];
+
 Golay_23_12::Golay_23_12()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Golay_23_12::~Golay_23_12()
@@ -880,6 +968,9 @@ void Golay_23_12::init()
             }
         }
     }
+
+    fecBuildHMasks(m_H, 23, 11, m_hMasks);
+    fecBuildCorrMasks(&m_corr[0][0], 2048, 3, 23, m_corrMasks);
 }
 
 // Not very efficient but encode is used for unit testing only
@@ -903,65 +994,47 @@ void Golay_23_12::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Golay_23_12::decode(unsigned char *rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = fecPack(rxBits, 23);
+    uint32_t data;
+    int nbErrors;
+    bool correctable = decode(codeword, data, nbErrors);
+    fecUnpack(codeword, rxBits, 23);
+    return correctable;
+}
 
-    for (int is = 0; is < 11; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[23*is + 0])
-                    + (rxBits[1] * m_H[23*is + 1])
-                    + (rxBits[2] * m_H[23*is + 2])
-                    + (rxBits[3] * m_H[23*is + 3])
-                    + (rxBits[4] * m_H[23*is + 4])
-                    + (rxBits[5] * m_H[23*is + 5])
-                    + (rxBits[6] * m_H[23*is + 6])
-                    + (rxBits[7] * m_H[23*is + 7])
-                    + (rxBits[8] * m_H[23*is + 8])
-                    + (rxBits[9] * m_H[23*is + 9])
-                    + (rxBits[10] * m_H[23*is + 10])
-                    + (rxBits[11] * m_H[23*is + 11])
-                    + (rxBits[12] * m_H[23*is + 12])
-                    + (rxBits[13] * m_H[23*is + 13])
-                    + (rxBits[14] * m_H[23*is + 14])
-                    + (rxBits[15] * m_H[23*is + 15])
-                    + (rxBits[16] * m_H[23*is + 16])
-                    + (rxBits[17] * m_H[23*is + 17])
-                    + (rxBits[18] * m_H[23*is + 18])
-                    + (rxBits[19] * m_H[23*is + 19])
-                    + (rxBits[20] * m_H[23*is + 20])
-                    + (rxBits[21] * m_H[23*is + 21])
-                    + (rxBits[22] * m_H[23*is + 22])) % 2) << (10-is);
-    }
+bool Golay_23_12::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 11);
+    bool correctable = true;
+    nbErrors = 0;
 
     if (syndromeI > 0)
     {
-        int i = 0;
-
-        for (; i < 3; i++)
+        if (m_corrMasks[syndromeI] == 0)
         {
-            if (m_corr[syndromeI][i] == 0xFF)
-            {
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
-            }
+            correctable = false;
         }
-
-        if (i == 0)
+        else
         {
-            return false;
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
         }
     }
 
-    return true;
+    data = codeword >> 11;
+    return correctable;
 }
 
 // ========================================================================================
 
+uint32_t Golay_24_12::m_hMasks[12];
+uint32_t Golay_24_12::m_corrMasks[4096];
+unsigned char Golay_24_12::m_corr[4096][3];
+
 Golay_24_12::Golay_24_12()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Golay_24_12::~Golay_24_12()
@@ -1059,6 +1132,9 @@ void Golay_24_12::init()
             }
         }
     }
+
+    fecBuildHMasks(m_H, 24, 12, m_hMasks);
+    fecBuildCorrMasks(&m_corr[0][0], 4096, 3, 24, m_corrMasks);
 }
 
 // Not very efficient but encode is used for unit testing only
@@ -1082,66 +1158,47 @@ void Golay_24_12::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Golay_24_12::decode(unsigned char *rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = fecPack(rxBits, 24);
+    uint32_t data;
+    int nbErrors;
+    bool correctable = decode(codeword, data, nbErrors);
+    fecUnpack(codeword, rxBits, 24);
+    return correctable;
+}
 
-    for (int is = 0; is < 12; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[24*is + 0])
-                    + (rxBits[1] * m_H[24*is + 1])
-                    + (rxBits[2] * m_H[24*is + 2])
-                    + (rxBits[3] * m_H[24*is + 3])
-                    + (rxBits[4] * m_H[24*is + 4])
-                    + (rxBits[5] * m_H[24*is + 5])
-                    + (rxBits[6] * m_H[24*is + 6])
-                    + (rxBits[7] * m_H[24*is + 7])
-                    + (rxBits[8] * m_H[24*is + 8])
-                    + (rxBits[9] * m_H[24*is + 9])
-                    + (rxBits[10] * m_H[24*is + 10])
-                    + (rxBits[11] * m_H[24*is + 11])
-                    + (rxBits[12] * m_H[24*is + 12])
-                    + (rxBits[13] * m_H[24*is + 13])
-                    + (rxBits[14] * m_H[24*is + 14])
-                    + (rxBits[15] * m_H[24*is + 15])
-                    + (rxBits[16] * m_H[24*is + 16])
-                    + (rxBits[17] * m_H[24*is + 17])
-                    + (rxBits[18] * m_H[24*is + 18])
-                    + (rxBits[19] * m_H[24*is + 19])
-                    + (rxBits[20] * m_H[24*is + 20])
-                    + (rxBits[21] * m_H[24*is + 21])
-                    + (rxBits[22] * m_H[24*is + 22])
-                    + (rxBits[23] * m_H[24*is + 23])) % 2) << (11-is);
-    }
+bool Golay_24_12::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 12);
+    bool correctable = true;
+    nbErrors = 0;
 
     if (syndromeI > 0)
     {
-        int i = 0;
-
-        for (; i < 3; i++)
+        if (m_corrMasks[syndromeI] == 0)
         {
-            if (m_corr[syndromeI][i] == 0xFF)
-            {
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
-            }
+            correctable = false;
         }
-
-        if (i == 0)
+        else
         {
-            return false;
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
         }
     }
 
-    return true;
+    data = codeword >> 12;
+    return correctable;
 }
 
 // ========================================================================================
 
+uint32_t QR_16_7_6::m_hMasks[9];
+uint32_t QR_16_7_6::m_corrMasks[512];
+unsigned char QR_16_7_6::m_corr[512][2];
+
 QR_16_7_6::QR_16_7_6()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 QR_16_7_6::~QR_16_7_6()
@@ -1198,6 +1255,9 @@ void QR_16_7_6::init()
             m_corr[syndromeIP2][1] = 7 + ip2;
         }
     }
+
+    fecBuildHMasks(m_H, 16, 9, m_hMasks);
+    fecBuildCorrMasks(&m_corr[0][0], 512, 2, 16, m_corrMasks);
 }
 
 // Not very efficient but encode is used for unit testing only
@@ -1221,51 +1281,35 @@ void QR_16_7_6::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool QR_16_7_6::decode(unsigned char *rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = fecPack(rxBits, 16);
+    uint32_t data;
+    int nbErrors;
+    bool correctable = decode(codeword, data, nbErrors);
+    fecUnpack(codeword, rxBits, 16);
+    return correctable;
+}
 
-    for (int is = 0; is < 9; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[16*is + 0])
-                    + (rxBits[1] * m_H[16*is + 1])
-                    + (rxBits[2] * m_H[16*is + 2])
-                    + (rxBits[3] * m_H[16*is + 3])
-                    + (rxBits[4] * m_H[16*is + 4])
-                    + (rxBits[5] * m_H[16*is + 5])
-                    + (rxBits[6] * m_H[16*is + 6])
-                    + (rxBits[7] * m_H[16*is + 7])
-                    + (rxBits[8] * m_H[16*is + 8])
-                    + (rxBits[9] * m_H[16*is + 9])
-                    + (rxBits[10] * m_H[16*is + 10])
-                    + (rxBits[11] * m_H[16*is + 11])
-                    + (rxBits[12] * m_H[16*is + 12])
-                    + (rxBits[13] * m_H[16*is + 13])
-                    + (rxBits[14] * m_H[16*is + 14])
-                    + (rxBits[15] * m_H[16*is + 15])) % 2) << (8-is);
-    }
+bool QR_16_7_6::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 9);
+    bool correctable = true;
+    nbErrors = 0;
 
     if (syndromeI > 0)
     {
-        int i = 0;
-
-        for (; i < 2; i++)
+        if (m_corrMasks[syndromeI] == 0)
         {
-            if (m_corr[syndromeI][i] == 0xFF)
-            {
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
-            }
+            correctable = false;
         }
-
-        if (i == 0)
+        else
         {
-            return false;
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
         }
     }
 
-    return true;
+    data = codeword >> 9;
+    return correctable;
 }
 
 const unsigned char Hamming_10_6_3::m_G[10 * 6] = {
@@ -1285,9 +1329,14 @@ const unsigned char Hamming_10_6_3::m_H[10 * 4] = {
     //  0  1  2  3  4  5 <- correctable bit positions
 };
 
+uint32_t Hamming_10_6_3::m_hMasks[4];
+uint32_t Hamming_10_6_3::m_corrMasks[16];
+unsigned char Hamming_10_6_3::m_corr[16];
+
 Hamming_10_6_3::Hamming_10_6_3()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Hamming_10_6_3::~Hamming_10_6_3()
@@ -1308,6 +1357,9 @@ void Hamming_10_6_3::init()
     m_corr[0b0100] = 7;
     m_corr[0b0010] = 8;
     m_corr[0b0001] = 9;
+
+    fecBuildHMasks(m_H, 10, 4, m_hMasks);
+    fecBuildCorrMasks(m_corr, 16, 1, 10, m_corrMasks);
 }
 
 void Hamming_10_6_3::encode(unsigned char* origBits, unsigned char* encodedBits)
@@ -1330,35 +1382,35 @@ void Hamming_10_6_3::encode(unsigned char* origBits, unsigned char* encodedBits)
 
 bool Hamming_10_6_3::decode(unsigned char* rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = fecPack(rxBits, 10);
+    uint32_t data;
+    int nbErrors;
+    bool correctable = decode(codeword, data, nbErrors);
+    fecUnpack(codeword, rxBits, 10);
+    return correctable;
+}
 
-    for (int is = 0; is < 4; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[10 * is + 0])
-            + (rxBits[1] * m_H[10 * is + 1])
-            + (rxBits[2] * m_H[10 * is + 2])
-            + (rxBits[3] * m_H[10 * is + 3])
-            + (rxBits[4] * m_H[10 * is + 4])
-            + (rxBits[5] * m_H[10 * is + 5])
-            + (rxBits[6] * m_H[10 * is + 6])
-            + (rxBits[7] * m_H[10 * is + 7])
-            + (rxBits[8] * m_H[10 * is + 8])
-            + (rxBits[9] * m_H[10 * is + 9])) % 2) << (3 - is);
-    }
+bool Hamming_10_6_3::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 4);
+    bool correctable = true;
+    nbErrors = 0;
 
     if (syndromeI > 0)
     {
-        if (m_corr[syndromeI] == 0xFF)
+        if (m_corrMasks[syndromeI] == 0)
         {
-            return false;
+            correctable = false;
         }
         else
         {
-            rxBits[m_corr[syndromeI]] ^= 1; // flip bit
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
         }
     }
 
-    return true;
+    data = codeword >> 4;
+    return correctable;
 }
 
 // ========================================================================================
@@ -1396,9 +1448,14 @@ const unsigned char Golay_24_12_8::m_H[24 * 12] = {
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0,   1, 0, 0, 1, 0, 0, 1, 1, 1, 1, 1, 0,
 };
 
+uint32_t Golay_24_12_8::m_hMasks[12];
+uint32_t Golay_24_12_8::m_corrMasks[4096];
+unsigned char Golay_24_12_8::m_corr[4096][8];
+
 Golay_24_12_8::Golay_24_12_8()
 {
-    init();
+    static const bool initialized = (init(), true);
+    (void) initialized;
 }
 
 Golay_24_12_8::~Golay_24_12_8()
@@ -1438,6 +1495,9 @@ void Golay_24_12_8::init()
     }
 
     // Higher order patterns would be added here for full 8-bit correction
+
+    fecBuildHMasks(m_H, 24, 12, m_hMasks);
+    fecBuildCorrMasks(&m_corr[0][0], 4096, 8, 24, m_corrMasks);
 }
 
 void Golay_24_12_8::encode(unsigned char* origBits, unsigned char* encodedBits)
@@ -1460,29 +1520,35 @@ void Golay_24_12_8::encode(unsigned char* origBits, unsigned char* encodedBits)
 
 bool Golay_24_12_8::decode(unsigned char* rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = fecPack(rxBits, 24);
+    uint32_t data;
+    int nbErrors;
+    decode(codeword, data, nbErrors);
+    fecUnpack(codeword, rxBits, 24);
+    return true; // Golay codes can usually correct within their capability
+}
 
-    for (int is = 0; is < 12; is++)
-    {
-        int sum = 0;
-        for (int j = 0; j < 24; j++)
-        {
-            sum += rxBits[j] * m_H[24 * is + j];
-        }
-        syndromeI += (sum % 2) << (11 - is);
-    }
+bool Golay_24_12_8::decode(uint32_t& codeword, uint32_t& data, int& nbErrors)
+{
+    unsigned int syndromeI = fecSyndrome(codeword, m_hMasks, 12);
+    bool correctable = true;
+    nbErrors = 0;
 
     if (syndromeI > 0)
     {
-        // Correct up to 8 bits
-        for (int i = 0; i < 8; i++)
+        if (m_corrMasks[syndromeI] == 0)
+        {
+            correctable = false;
+        }
+        else
         {
-            if (m_corr[syndromeI][i] == 0xFF) break;
-            rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
+            codeword ^= m_corrMasks[syndromeI]; // flip bits
+            nbErrors = fecPopcount(m_corrMasks[syndromeI]);
         }
     }
 
-    return true; // Golay codes can usually correct within their capability
+    data = codeword >> 12;
+    return correctable;
 }
 
 // Add this implementation at the end of fec.cpp:
@@ -1556,4 +1622,133 @@ bool BCH_63_16_5::correctErrors(unsigned char* data, unsigned int syndrome)
     return true; // Assume correctable for now
 }
 
+// ========================================================================================
+
+const unsigned char P25Trellis_1_2::m_points[4*4] = {
+    0x2, 0xC, 0x1, 0xF,
+    0xE, 0x0, 0xD, 0x3,
+    0x9, 0x7, 0xA, 0x4,
+    0x5, 0xB, 0x6, 0x8
+};
+
+const unsigned char P25Trellis_3_4::m_points[8*8] = {
+    0x2, 0xD, 0xE, 0x1, 0x7, 0x8, 0xB, 0x4,
+    0xE, 0x1, 0x7, 0x8, 0xB, 0x4, 0x2, 0xD,
+    0xA, 0x5, 0x6, 0x9, 0xF, 0x0, 0x3, 0xC,
+    0x6, 0x9, 0xF, 0x0, 0x3, 0xC, 0xA, 0x5,
+    0xF, 0x0, 0x3, 0xC, 0xA, 0x5, 0x6, 0x9,
+    0x3, 0xC, 0xA, 0x5, 0x6, 0x9, 0xF, 0x0,
+    0x7, 0x8, 0xB, 0x4, 0x2, 0xD, 0xE, 0x1,
+    0xB, 0x4, 0x2, 0xD, 0xE, 0x1, 0x7, 0x8
+};
+
+P25Trellis::P25Trellis(int nbStates, const unsigned char *constellation) :
+        m_nbStates(nbStates),
+        m_constellation(constellation)
+{
+    // distance in number of C4FM levels between dibits (+1, +3, -1, -3) rather than bit errors
+    // because the constellation is designed for distance between levels
+    static const int levels[4] = {2, 3, 1, 0};
+
+    for (int point = 0; point < 16; point++)
+    {
+        for (int t = 0; t < nbStates*nbStates; t++)
+        {
+            int d1 = levels[point >> 2] - levels[constellation[t] >> 2];
+            int d2 = levels[point & 3] - levels[constellation[t] & 3];
+            m_branchMetrics[point*nbStates*nbStates + t] = (d1 < 0 ? -d1 : d1) + (d2 < 0 ? -d2 : d2);
+        }
+    }
+}
+
+P25Trellis::~P25Trellis()
+{
+}
+
+void P25Trellis::encode(const unsigned char *symbols, unsigned char *dibits) const
+{
+    unsigned char state = 0;
+
+    for (int i = 0; i < 49; i++)
+    {
+        unsigned char symbol = i < 48 ? symbols[i] : 0; // flush
+        unsigned char point = m_constellation[state*m_nbStates + symbol];
+        *dibits++ = point >> 2;
+        *dibits++ = point & 3;
+        state = symbol;
+    }
+}
+
+int P25Trellis::decode(const unsigned char *dibits, unsigned char *symbols) const
+{
+    int metrics[2][8];
+    unsigned char survivors[49][8]; // best previous state by step and state
+    int *pm = metrics[0];
+    int *npm = metrics[1];
+
+    for (int s = 0; s < m_nbStates; s++) {
+        pm[s] = s == 0 ? 0 : 6*49; // start in state 0
+    }
+
+    for (int i = 0; i < 49; i++)
+    {
+        unsigned char point = ((dibits[2*i] & 3) << 2) | (dibits[2*i+1] & 3);
+        const unsigned char *bm = &m_branchMetrics[point*m_nbStates*m_nbStates];
+
+        for (int next = 0; next < m_nbStates; next++)
+        {
+            int best = pm[0] + bm[next];
+            unsigned char bestPrev = 0;
+
+            for (int prev = 1; prev < m_nbStates; prev++)
+            {
+                int m = pm[prev] + bm[prev*m_nbStates + next];
+
+                if (m < best)
+                {
+                    best = m;
+                    bestPrev = prev;
+                }
+            }
+
+            npm[next] = best;
+            survivors[i][next] = bestPrev;
+        }
+
+        int *tmp = pm;
+        pm = npm;
+        npm = tmp;
+    }
+
+    // trace back from the flushed state
+
+    unsigned char state = 0;
+
+    for (int i = 48; i > 0; i--)
+    {
+        state = survivors[i][state];
+        symbols[i-1] = state;
+    }
+
+    return pm[0];
+}
+
+P25Trellis_1_2::P25Trellis_1_2() :
+        P25Trellis(4, m_points)
+{
+}
+
+P25Trellis_1_2::~P25Trellis_1_2()
+{
+}
+
+P25Trellis_3_4::P25Trellis_3_4() :
+        P25Trellis(8, m_points)
+{
+}
+
+P25Trellis_3_4::~P25Trellis_3_4()
+{
+}
+
 } // namespace DSDcc
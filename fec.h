@@ -20,6 +20,8 @@
 #include <sdkddkver.h>
 #include <afx.h>
 
+#include <stdint.h>
+
 #include "export.h"
 
 
@@ -32,12 +34,16 @@ public:
 	Hamming_7_4();
 	~Hamming_7_4();
 
-	void init();
 	void encode(unsigned char *origBits, unsigned char *encodedBits);
 	bool decode(unsigned char *rxBits);
+	bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-	unsigned char m_corr[8];             //!< single bit error correction by syndrome index
+	static void init();
+
+	static unsigned char m_corr[8];      //!< single bit error correction by syndrome index, shared by all instances
+	static uint32_t m_hMasks[3];         //!< Parity check matrix rows as masks over the packed codeword
+	static uint32_t m_corrMasks[8];      //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[7*4]; //!< Generator matrix of bits
 	static const unsigned char m_H[7*3]; //!< Parity check matrix of bits
 };
@@ -48,12 +54,16 @@ public:
     Hamming_12_8();
     ~Hamming_12_8();
 
-    void init();
 	void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords);
+    bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-    unsigned char m_corr[16];             //!< single bit error correction by syndrome index
+    static void init();
+
+    static unsigned char m_corr[16];      //!< single bit error correction by syndrome index, shared by all instances
+    static uint32_t m_hMasks[4];          //!< Parity check matrix rows as masks over the packed codeword
+    static uint32_t m_corrMasks[16];      //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[12*8]; //!< Generator matrix of bits
     static const unsigned char m_H[12*4]; //!< Parity check matrix of bits
 };
@@ -64,12 +74,16 @@ public:
     Hamming_15_11();
     ~Hamming_15_11();
 
-    void init();
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords);
+    bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-    unsigned char m_corr[16];              //!< single bit error correction by syndrome index
+    static void init();
+
+    static unsigned char m_corr[16];       //!< single bit error correction by syndrome index, shared by all instances
+    static uint32_t m_hMasks[4];           //!< Parity check matrix rows as masks over the packed codeword
+    static uint32_t m_corrMasks[16];       //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[15*11]; //!< Generator matrix of bits
     static const unsigned char m_H[15*4];  //!< Parity check matrix of bits
 };
@@ -80,12 +94,16 @@ public:
     Hamming_16_11_4();
     ~Hamming_16_11_4();
 
-    void init();
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords);
+    bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-    unsigned char m_corr[32];              //!< single bit error correction by syndrome index
+    static void init();
+
+    static unsigned char m_corr[32];       //!< single bit error correction by syndrome index, shared by all instances
+    static uint32_t m_hMasks[5];           //!< Parity check matrix rows as masks over the packed codeword
+    static uint32_t m_corrMasks[32];       //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[16*11]; //!< Generator matrix of bits
     static const unsigned char m_H[16*5];  //!< Parity check matrix of bits
 };
@@ -96,12 +114,16 @@ public:
 	Golay_20_8();
 	~Golay_20_8();
 
-	void init();
 	void encode(unsigned char *origBits, unsigned char *encodedBits);
 	bool decode(unsigned char *rxBits);
+	bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-	unsigned char m_corr[4096][3];         //!< up to 3 bit error correction by syndrome index
+	static void init();
+
+	static unsigned char m_corr[4096][3];  //!< up to 3 bit error correction by syndrome index, shared by all instances
+	static uint32_t m_hMasks[12];          //!< Parity check matrix rows as masks over the packed codeword
+	static uint32_t m_corrMasks[4096];     //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[20*8];  //!< Generator matrix of bits
     static const unsigned char m_H[20*12]; //!< Parity check matrix of bits
 };
@@ -112,12 +134,16 @@ public:
     Golay_23_12();
     ~Golay_23_12();
 
-    void init();
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits);
+    bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-    unsigned char m_corr[2048][3];         //!< up to 3 bit error correction by syndrome index
+    static void init();
+
+    static unsigned char m_corr[2048][3];  //!< up to 3 bit error correction by syndrome index, shared by all instances
+    static uint32_t m_hMasks[11];          //!< Parity check matrix rows as masks over the packed codeword
+    static uint32_t m_corrMasks[2048];     //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[23*12]; //!< Generator matrix of bits
     static const unsigned char m_H[23*11]; //!< Parity check matrix of bits
 };
@@ -128,12 +154,16 @@ public:
     Golay_24_12();
     ~Golay_24_12();
 
-    void init();
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits);
+    bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-    unsigned char m_corr[4096][3];         //!< up to 3 bit error correction by syndrome index
+    static void init();
+
+    static unsigned char m_corr[4096][3];  //!< up to 3 bit error correction by syndrome index, shared by all instances
+    static uint32_t m_hMasks[12];          //!< Parity check matrix rows as masks over the packed codeword
+    static uint32_t m_corrMasks[4096];     //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[24*12]; //!< Generator matrix of bits
     static const unsigned char m_H[24*12]; //!< Parity check matrix of bits
 };
@@ -144,12 +174,16 @@ public:
 	QR_16_7_6();
 	~QR_16_7_6();
 
-	void init();
 	void encode(unsigned char *origBits, unsigned char *encodedBits);
 	bool decode(unsigned char *rxBits);
+	bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-	unsigned char m_corr[512][2];          //!< up to 2 bit error correction by syndrome index
+	static void init();
+
+	static unsigned char m_corr[512][2];   //!< up to 2 bit error correction by syndrome index, shared by all instances
+	static uint32_t m_hMasks[9];           //!< Parity check matrix rows as masks over the packed codeword
+	static uint32_t m_corrMasks[512];      //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[16*7];  //!< Generator matrix of bits
 	static const unsigned char m_H[16*9];  //!< Parity check matrix of bits
 };
@@ -160,12 +194,16 @@ public:
     Hamming_10_6_3();
     ~Hamming_10_6_3();
 
-    void init();
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits);
+    bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-    unsigned char m_corr[16];              //!< single bit error correction by syndrome index
+    static void init();
+
+    static unsigned char m_corr[16];       //!< single bit error correction by syndrome index, shared by all instances
+    static uint32_t m_hMasks[4];           //!< Parity check matrix rows as masks over the packed codeword
+    static uint32_t m_corrMasks[16];       //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[10*6]; //!< Generator matrix of bits
     static const unsigned char m_H[10*4]; //!< Parity check matrix of bits
 };
@@ -176,12 +214,16 @@ public:
     Golay_24_12_8();
     ~Golay_24_12_8();
 
-    void init();
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits);
+    bool decode(uint32_t& codeword, uint32_t& data, int& nbErrors); //!< codeword packed MSB first, corrected in place
 
 private:
-    unsigned char m_corr[4096][8];         //!< up to 8 bit error correction by syndrome index
+    static void init();
+
+    static unsigned char m_corr[4096][8];  //!< up to 8 bit error correction by syndrome index, shared by all instances
+    static uint32_t m_hMasks[12];          //!< Parity check matrix rows as masks over the packed codeword
+    static uint32_t m_corrMasks[4096];     //!< Error pattern by syndrome index over the packed codeword. 0 if not correctable
     static const unsigned char m_G[24*12]; //!< Generator matrix of bits
     static const unsigned char m_H[24*12]; //!< Parity check matrix of bits
 };
@@ -201,6 +243,48 @@ private:
     bool correctErrors(unsigned char *data, unsigned int syndrome);
 };
 
+/**
+ * P25 phase 1 trellis coded modulation (TIA-102.BAAA 7.2). Each input symbol (dibit for the 1/2 rate,
+ * tribit for the 3/4 rate) together with the previous one selects a 4 bit constellation point sent as
+ * 2 dibits. 98 dibits carry 48 symbols followed by a 0 flushing symbol. The encoder starts in state 0.
+ */
+class DSDCC_API P25Trellis
+{
+public:
+    ~P25Trellis();
+
+    void encode(const unsigned char *symbols, unsigned char *dibits) const; //!< 48 symbols in, 98 dibits out
+    int decode(const unsigned char *dibits, unsigned char *symbols) const; //!< 98 dibits in, 48 symbols out. Returns the level distance of the path ending in the flushed state
+
+protected:
+    P25Trellis(int nbStates, const unsigned char *constellation);
+
+private:
+    int m_nbStates;
+    const unsigned char *m_constellation;  //!< constellation point by previous and current symbol
+    unsigned char m_branchMetrics[16*8*8]; //!< level distance by received point then previous and current symbol
+};
+
+class DSDCC_API P25Trellis_1_2 : public P25Trellis
+{
+public:
+    P25Trellis_1_2();
+    ~P25Trellis_1_2();
+
+private:
+    static const unsigned char m_points[4*4]; //!< constellation point by previous and current dibit
+};
+
+class DSDCC_API P25Trellis_3_4 : public P25Trellis
+{
+public:
+    P25Trellis_3_4();
+    ~P25Trellis_3_4();
+
+private:
+    static const unsigned char m_points[8*8]; //!< constellation point by previous and current tribit
+};
+
 } // namespace DSDcc
 
 
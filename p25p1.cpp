@@ -20,7 +20,7 @@
 
 #include "p25p1.h"
 #include "dsd_decoder.h"
-#include <vector>
+#include <algorithm>
 
 // Suppress sprintf warnings
 #pragma warning(disable: 4996)
@@ -66,6 +66,7 @@ DSDP25P1::DSDP25P1(DSDDecoder *dsdDecoder) :
     m_frameIndex(0),
     m_encrypted(false),
     m_emergency(false),
+    m_rsValid(false),
     m_nac(0),
     m_duid(0),
     m_talkGroup(0),
@@ -75,8 +76,6 @@ DSDP25P1::DSDP25P1(DSDDecoder *dsdDecoder) :
     m_mfId(0),
     m_imbeFrameIndex(0),
     m_analogSignalIndex(0),
-    m_viterbi_3_4(3, 4, Viterbi::Poly25),       // 3/4 rate for voice
-    m_viterbi_1_2(1, 2, Viterbi::Poly25),       // 1/2 rate for TSBK/PDU 
     m_crcP25(CRC::PolyCCITT16, 16, 0x0000, 0xffff, 1, 0, 0)  
 {
     memset(m_nidData, 0, sizeof(m_nidData));
@@ -114,6 +113,7 @@ void DSDP25P1::init()
     // Reset P25 state
     m_encrypted = false;
     m_emergency = false;
+    m_rsValid = false;
     m_nac = 0;
     m_duid = 0;
     m_talkGroup = 0;
@@ -148,10 +148,15 @@ void DSDP25P1::process()
         if (bitPosition == 6) _frameData[byteIndex] = 0; // Clear byte at start of new dibit
         _frameData[byteIndex] |= dibit << bitPosition;   // Set dibit in byte
     }
-    else if (m_frameType = P25P1FrameTSBK)
+    else if (m_frameType == P25P1FrameTSBK)
     {
 		_deinterleavedDibits[_dataPktMap[m_symbolIndex]] = dibit;
 	}
+    else
+    {
+        processFramePayload(); // the other frame types take their payload dibit by dibit and count it themselves
+        return;
+    }
 
     m_symbolIndex++;
 	if (m_symbolIndex < _symbolsExpected)
@@ -289,7 +294,6 @@ void DSDP25P1::processLDU1()
     if (m_symbolIndex < 1584) // Voice data
     {
         int frameIdx = m_symbolIndex / 88;
-        int symbolInFrame = m_symbolIndex % 88;
         
         if (frameIdx < 18)
         {
@@ -302,11 +306,11 @@ void DSDP25P1::processLDU1()
     {
         if (m_symbolIndex == 1584)
         {
-            memset(m_lcData, 0, sizeof(m_lcData));
+            memset(m_rsData, 0, sizeof(m_rsData));
         }
 
-        int lcIndex = m_symbolIndex - 1584;
-        m_lcData[lcIndex / 6] |= m_dsdDecoder->m_dsdSymbol.getDibit() << (4 - (lcIndex % 6) * 2);
+        int lcIndex = m_symbolIndex - 1584; // 3 dibits per hexbit
+        m_rsData[lcIndex / 3] |= m_dsdDecoder->m_dsdSymbol.getDibit() << (4 - (lcIndex % 3) * 2);
         m_symbolIndex++;
         
         if (m_symbolIndex == 1656)
@@ -328,7 +332,13 @@ void DSDP25P1::processLDU1()
         if (m_symbolIndex == 1728)
         {
             extractStatusSymbols();
-            processHeuristics();
+
+            if (m_rsValid) {
+                processHeuristics();
+            } else {
+                m_analogSignalIndex = 0; // do not train heuristics on a corrupted LDU
+            }
+
             m_dsdDecoder->resetFrameSync();
         }
     }
@@ -347,11 +357,11 @@ void DSDP25P1::processLDU2()
     {
         if (m_symbolIndex == 1584)
         {
-            memset(m_esData, 0, sizeof(m_esData));
+            memset(m_rsData, 0, sizeof(m_rsData));
         }
 
-        int esIndex = m_symbolIndex - 1584;
-        m_esData[esIndex / 18] |= m_dsdDecoder->m_dsdSymbol.getDibit() << (16 - (esIndex % 18) * 2);
+        int esIndex = m_symbolIndex - 1584; // 3 dibits per hexbit
+        m_rsData[esIndex / 3] |= m_dsdDecoder->m_dsdSymbol.getDibit() << (4 - (esIndex % 3) * 2);
         m_symbolIndex++;
         
         if (m_symbolIndex == 1656)
@@ -368,7 +378,13 @@ void DSDP25P1::processLDU2()
         if (m_symbolIndex == 1728)
         {
             extractStatusSymbols();
-            processHeuristics();
+
+            if (m_rsValid) {
+                processHeuristics();
+            } else {
+                m_analogSignalIndex = 0; // do not train heuristics on a corrupted LDU
+            }
+
             m_dsdDecoder->resetFrameSync();
         }
     }
@@ -378,13 +394,12 @@ void DSDP25P1::processVoiceFrame(int frameIndex)
 {
     if (frameIndex >= 18) return;
     
-    int dibit = m_dsdDecoder->m_dsdSymbol.getDibit();
     int symbolInFrame = m_symbolIndex % 88;
     
     // Extract IMBE voice data (simplified mapping)
     if (symbolInFrame < 88) // Each voice frame has 88 dibits
     {
-        extractIMBE(m_imbeFrame[frameIndex], frameIndex);
+        extractIMBE(m_imbeFrame[frameIndex]);
         
         // Process complete IMBE frame
         if (symbolInFrame == 87)
@@ -424,7 +439,7 @@ void DSDP25P1::processVoiceFrame(int frameIndex)
     }
 }
 
-void DSDP25P1::extractIMBE(unsigned char* imbeFrame, int frameIndex)
+void DSDP25P1::extractIMBE(unsigned char* imbeFrame)
 {
     // Simplified IMBE extraction - would need full P25 voice frame structure
     int dibit = m_dsdDecoder->m_dsdSymbol.getDibit();
@@ -438,15 +453,18 @@ void DSDP25P1::extractIMBE(unsigned char* imbeFrame, int frameIndex)
 
 void DSDP25P1::extractLinkControl()
 {
-    // Decode Link Control with Golay(24,12,8) error correction
-    if (decodeGolay_24_12_8(m_lcData))
+    // Decode Link Control with RS(24,12,13) error correction
+    m_rsValid = decodeReedSolomon_24_12_13(m_rsData);
+
+    if (m_rsValid)
     {
-        // Extract talk group and source from link control
-        m_talkGroup = (m_lcData[2] << 8) | m_lcData[3];
-        m_source = (m_lcData[4] << 16) | (m_lcData[5] << 8) | m_lcData[6];
+        // 12 data hexbits: LCF, MFID, service options, reserved, talk group (16), source (24)
+        packHexbits(m_rsData, m_lcData, 12);
+        m_talkGroup = (m_lcData[4] << 8) | m_lcData[5];
+        m_source = (m_lcData[6] << 16) | (m_lcData[7] << 8) | m_lcData[8];
         
-        // Check for emergency bit
-        m_emergency = (m_lcData[0] & 0x80) != 0;
+        // Check for emergency bit in service options
+        m_emergency = (m_lcData[2] & 0x80) != 0;
         
         // Update decoder state
         m_dsdDecoder->m_state.lasttg = m_talkGroup;
@@ -454,13 +472,27 @@ void DSDP25P1::extractLinkControl()
         
         TRACE("P25: TG:%d SRC:%d %s\n", m_talkGroup, m_source, m_emergency ? "EMERGENCY" : "");
     }
+    else
+    {
+        TRACE("P25: LC Reed-Solomon decode failed\n");
+    }
 }
 
 void DSDP25P1::extractEncryptionSync()
 {
-    // Decode Encryption Sync
-    m_algId = m_esData[0];
-    m_keyId = (m_esData[1] << 8) | m_esData[2];
+    // Decode Encryption Sync with RS(24,16,9) error correction
+    m_rsValid = decodeReedSolomon_24_16_9(m_rsData);
+
+    if (!m_rsValid)
+    {
+        TRACE("P25: ES Reed-Solomon decode failed\n");
+        return;
+    }
+
+    // 16 data hexbits: message indicator (72), algorithm ID (8), key ID (16)
+    packHexbits(m_rsData, m_esData, 16);
+    m_algId = m_esData[9];
+    m_keyId = (m_esData[10] << 8) | m_esData[11];
     m_encrypted = (m_algId != 0x80); // 0x80 = unencrypted
     
     // Update decoder state - Fix: Use sprintf_s for safety
@@ -496,18 +528,20 @@ void DSDP25P1::processTSBK()
     // Ref: TIA-102.AABB-B and TIA-102.AABC-B
 
     // TSBK is encoded with 1/2 rate Trellis coding
-    if (decodeTrellis_1_2() == false)
-    {
-        TRACE("P25: TSBK decode error\n");
-        m_dsdDecoder->resetFrameSync();
-		return; // Decode error, return failure
-    }
+    decodeTrellis_1_2();
 	// Now we have the decoded TSBK data in _frameData
  
-    // Check CRC-16 on decoded data (first 10 bytes data + 2 bytes CRC)
+    // Check CRC-16 on decoded data (first 10 bytes data + 2 bytes CRC). It decides if the trellis decoding is right
     unsigned short receivedCRC = (_frameData[10] << 8) | _frameData[11];
     unsigned short calculatedCRC = (unsigned short)m_crcP25.crcbitbybit(_frameData, 10);
 
+    if (receivedCRC != calculatedCRC)
+    {
+        TRACE("P25: TSBK CRC error\n");
+        m_dsdDecoder->resetFrameSync();
+        return;
+    }
+
     // Extract TSBK fields from decoded data
     TSBK tsbk;
     tsbk.opcode = _frameData[0];
@@ -515,14 +549,11 @@ void DSDP25P1::processTSBK()
     memcpy(tsbk.args, &_frameData[2], 8);
     tsbk.crc = receivedCRC;
 
-    unsigned char lb = (tsbk.opcode >> 7) & 0x01; // Last Block Flag
-    unsigned char pf = (tsbk.opcode >> 6) & 0x01; // Protected Flag
+    // Last Block Flag and Protected Flag
+    TRACE("P25: TSBK(%c%c) Opcode: 0x%02X MFID: 0x%02X\n",
+        (tsbk.opcode & 0x80) ? 'L' : '-', (tsbk.opcode & 0x40) ? 'P' : '-', tsbk.opcode & 0x3F, tsbk.mfId);
     tsbk.opcode &= 0x3F; // Clear flags, keep opcode
 
-    TRACE("P25: TSBK(%c%c) Opcode: 0x%02X MFID: 0x%02X CRC: %s\n",
-        lb ? 'L' : '-', pf ? 'P' : '-', tsbk.opcode, tsbk.mfId,
-        (receivedCRC == calculatedCRC) ? "OK" : "FAIL");
-
     if (tsbk.mfId == 0x00 || tsbk.mfId == 0x01)
     {
         processTSBKOpcode(tsbk);
@@ -587,52 +618,35 @@ void DSDP25P1::processPDU()
     m_dsdDecoder->resetFrameSync();
 }
 
-int DSDP25P1::find_min(uint8_t list[], int len)
+bool DSDP25P1::decodeHamming_10_6_3(unsigned char* data)
 {
-    int min = list[0];
-    int index = 0;
-    int unique = 1;
-    int i;
-
-    for (i = 1; i < len; i++) {
-        if (list[i] < min) {
-            min = list[i];
-            index = i;
-            unique = 1;
-        }
-        else if (list[i] == min) {
-            unique = 0;
-        }
-    }
-    /* return -1 if a minimum can't be found */
-    if (!unique)
-        return -1;
-
-    return index;
+    return m_hamming_10_6_3.decode(data);
 }
 
-int DSDP25P1::count_bits(unsigned int n)
+bool DSDP25P1::decodeGolay_24_12_8(unsigned char* data)
 {
-    int i = 0;
-    for (i = 0; n != 0; i++)
-        n &= n - 1;
-    return i;
+    return m_golay_24_12_8.decode(data);
 }
 
-bool DSDP25P1::decodeHamming_10_6_3(unsigned char* data)
+bool DSDP25P1::decodeReedSolomon_24_12_13(unsigned char* hexbits)
 {
-    return m_hamming_10_6_3.decode(data);
+    return m_reedSolomon_24_12_13.decode(hexbits);
 }
 
-bool DSDP25P1::decodeGolay_24_12_8(unsigned char* data)
+bool DSDP25P1::decodeReedSolomon_24_16_9(unsigned char* hexbits)
 {
-    return m_golay_24_12_8.decode(data);
+    return m_reedSolomon_24_16_9.decode(hexbits);
 }
 
-bool DSDP25P1::decodeReedSolomon_24_12_13(unsigned char* data, int blocks)
+// Pack hexbits 4 by 4 into 3 bytes MSB first
+void DSDP25P1::packHexbits(const unsigned char* hexbits, unsigned char* bytes, int nbHexbits)
 {
-    // Reed-Solomon decoding would be implemented here
-    return true; // Assume success for now
+    for (int i = 0; i < nbHexbits; i += 4)
+    {
+        *bytes++ = (hexbits[i] << 2) | (hexbits[i+1] >> 4);
+        *bytes++ = ((hexbits[i+1] & 0x0F) << 4) | (hexbits[i+2] >> 2);
+        *bytes++ = ((hexbits[i+2] & 0x03) << 6) | hexbits[i+3];
+    }
 }
 
 bool DSDP25P1::decodeBCH_63_16_5(unsigned char* data)
@@ -640,65 +654,18 @@ bool DSDP25P1::decodeBCH_63_16_5(unsigned char* data)
     return m_bch_63_16_5.decode(data);
 }
 
-bool DSDP25P1::decodeTrellis_3_4(unsigned char* data, int length)
-{
-    // Fix: Use std::vector instead of VLA for C++ compatibility
-    std::vector<unsigned char> decoded(length * 3 / 4);
-    m_viterbi_3_4.decodeFromBits(decoded.data(), data, length, 0);
-    memcpy(data, decoded.data(), length * 3 / 4);
-    return true;
-}
-
 // Decode deinterleaved dibits using 1/2 rate Trellis coding
 // This is used for TSBK and PDU frames and is always 98 dibits input 48 dibits output per BAAA section 7
-bool DSDP25P1::decodeTrellis_1_2()
+void DSDP25P1::decodeTrellis_1_2()
 {
-    int i, j;
-    int state = 0;
-    uint8_t codeword;
-    uint8_t hd[4];  // Hamming distances for each candidate codeword
-
-    static const uint8_t next_words[4][4] = {
-        {0x2, 0xC, 0x1, 0xF},
-        {0xE, 0x0, 0xD, 0x3},
-        {0x9, 0x7, 0xA, 0x4},
-        {0x5, 0xB, 0x6, 0x8}
-    };
+    unsigned char dibits[48];
+    m_trellis_1_2.decode(_deinterleavedDibits, dibits);
 
     memset(_frameData, 0, sizeof(_frameData));
 
-    /* step through 4 bit codewords in input */
-    for (i = 0; i < 98; i += 2) {
-        codeword = ((_deinterleavedDibits[i] << 2) | (_deinterleavedDibits[i + 1]));
-        /* try each codeword in a row of the state transition table */
-        for (j = 0; j < 4; j++) {
-            /* find Hamming distance for candidate */
-            hd[j] = count_bits(codeword ^ next_words[state][j]);
-        }
-        /* find the dibit that matches the most codeword bits (minimum Hamming distance) */
-        state = find_min(hd, 4);
-        /* error if minimum can't be found */
-        if (state == -1)
-        {
-            //TRACE("P25: TSBK decode error at dibit %d, codeword: %02X\n", i / 2, codeword);
-            m_dsdDecoder->resetFrameSync();
-            return false;	// decode error, return failure
-        }
-        /* It also might be nice to report a condition where the minimum is
-         * non-zero, i.e. an error has been corrected.  It probably shouldn't
-         * be a permanent failure, though.
-         *
-         * DISSECTOR_ASSERT(hd[state] == 0);
-         */
-
-         /* append dibit onto output buffer */
-        if (i < 96)
-        {
-            int bitPosition = (6 - (((i / 2) % 4) * 2));
-            _frameData[(i / 8)] |= state << bitPosition;
-        }
+    for (int i = 0; i < 48; i++) {
+        _frameData[i / 4] |= dibits[i] << (6 - (i % 4) * 2);
     }
-    return true;
 }
 
 void DSDP25P1::storeAnalogSignal(int value, int dibit)
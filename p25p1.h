@@ -19,7 +19,6 @@
 #define DSDCC_P25P1_H_
 
 #include "fec.h"
-#include "viterbi.h"
 #include "crc.h"
 #include "reed_solomon.h"
 #include "p25p1_heuristics.h"
@@ -106,7 +105,7 @@ private:
     void processTSBKOpcode(TSBK& tsbk);
     void processNetworkStatusBroadcast(TSBK& tsbk);
     
-    void extractIMBE(unsigned char* imbeFrame, int frameIndex);
+    void extractIMBE(unsigned char* imbeFrame);
     void extractLinkControl();
     void extractStatusSymbols();
     void extractEncryptionSync();
@@ -114,15 +113,14 @@ private:
     bool decodeBCH_63_16_5(unsigned char* data);
     bool decodeHamming_10_6_3(unsigned char* data);
     bool decodeGolay_24_12_8(unsigned char* data);
-    bool decodeReedSolomon_24_12_13(unsigned char* data, int blocks);
-    bool decodeTrellis_3_4(unsigned char* data, int length);
-    bool decodeTrellis_1_2(); 
+    bool decodeReedSolomon_24_12_13(unsigned char* hexbits);
+    bool decodeReedSolomon_24_16_9(unsigned char* hexbits);
+    void decodeTrellis_1_2();
     
     void storeAnalogSignal(int value, int dibit);
     void processHeuristics();
 
-    int count_bits(unsigned int n);
-    int find_min(uint8_t list[], int len);
+    static void packHexbits(const unsigned char* hexbits, unsigned char* bytes, int nbHexbits);
 
     DSDDecoder *m_dsdDecoder;
     
@@ -133,6 +131,7 @@ private:
     int m_frameIndex;
     bool m_encrypted;
     bool m_emergency;
+    bool m_rsValid;              // Reed-Solomon protected LC or ES of the current LDU was decoded
 	int _symbolsExpected;        // Number of dibits to acquire before next processing step
 	int _statusIndex;            // Index for status symbol removal and processing   
     
@@ -148,8 +147,8 @@ private:
     // Frame data buffers
     unsigned char m_nidData[8];
     unsigned char m_lcData[12];
-    unsigned char m_esData[4];
-    unsigned char m_rsData[24];
+    unsigned char m_esData[12];
+    unsigned char m_rsData[24];  // LC or ES hexbits
     unsigned char m_statusData[18];
 	unsigned char _deinterleavedDibits[98];  
 	unsigned char _frameData[128];   
@@ -165,8 +164,8 @@ private:
     BCH_63_16_5 m_bch_63_16_5;
     Golay_24_12_8 m_golay_24_12_8;
     ReedSolomon_24_12_13 m_reedSolomon_24_12_13;
-    Viterbi m_viterbi_3_4;
-    Viterbi m_viterbi_1_2;  
+    ReedSolomon_24_16_9 m_reedSolomon_24_16_9;
+    P25Trellis_1_2 m_trellis_1_2;
     CRC m_crcP25;
     
     // Constants
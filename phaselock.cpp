@@ -165,8 +165,8 @@ void PhaseLock::process(const std::vector<float>& samples_in, std::vector<float>
     for (unsigned int i = 0; i < n; i++) {
 
         // Generate locked pilot tone.
-        float psin = sin(m_phase);
-        float pcos = cos(m_phase);
+        float psin, pcos;
+        sincos(m_phase, psin, pcos);
 
         // Generate double-frequency output.
         // sin(2*x) = 2 * sin(x) * cos(x)
@@ -246,12 +246,17 @@ void PhaseLock::process(const std::vector<float>& samples_in, std::vector<float>
 void PhaseLock::process(const float& sample_in, float *samples_out)
 {
 	// Generate locked pilot tone.
-	m_psin = sin(m_phase);
-	m_pcos = cos(m_phase);
+	sincos(m_phase, m_psin, m_pcos);
 
 	// Generate output
 	processPhase(samples_out);
 
+	track(sample_in);
+}
+
+
+void PhaseLock::track(float sample_in)
+{
 	// Multiply locked tone with input.
 	float x = sample_in;
 	float phasor_i = m_psin * x;
@@ -318,4 +323,38 @@ void PhaseLock::process(const float& sample_in, float *samples_out)
     m_sample_cnt += 1; // n
 }
 
+
+void PhaseLock::sincos(float phase, float& s, float& c)
+{
+    static const float halfPi = (float) (M_PI / 2.0);
+    static const float invHalfPi = (float) (2.0 / M_PI);
+
+    float q = std::floor(phase * invHalfPi + 0.5f);
+    float r = phase - q * halfPi; // [-pi/4, pi/4]
+    float r2 = r * r;
+
+    float sr = r * (1.0f + r2 * (-1.0f/6.0f + r2 * (1.0f/120.0f + r2 * (-1.0f/5040.0f + r2 * (1.0f/362880.0f)))));
+    float cr = 1.0f + r2 * (-0.5f + r2 * (1.0f/24.0f + r2 * (-1.0f/720.0f + r2 * (1.0f/40320.0f))));
+
+    switch (((int) q) & 3)
+    {
+    case 0:
+        s = sr;
+        c = cr;
+        break;
+    case 1:
+        s = cr;
+        c = -sr;
+        break;
+    case 2:
+        s = -sr;
+        c = -cr;
+        break;
+    default:
+        s = -cr;
+        c = sr;
+        break;
+    }
+}
+
 } // namespace DSDcc
@@ -65,6 +65,23 @@ public:
      */
     void process(const std::vector<float>& samples_in, std::vector<float>& samples_out);
 
+    /**
+     * Process one sample and return the sine of the locked phase as it was before the update.
+     * This is what SimplePhaseLock would put in samples_out[0] without the virtual call.
+     */
+    float processSin(float sample_in)
+    {
+        sincos(m_phase, m_psin, m_pcos);
+        track(sample_in);
+        return m_psin;
+    }
+
+    /**
+     * Sine and cosine of a phase in radians. Quadrant reduction then Taylor polynomials
+     * on [-pi/4, pi/4] so the error stays within a few float ulps. Used as the NCO.
+     */
+    static void sincos(float phase, float& s, float& c);
+
     /** Return true if the phase-locked loop is locked. */
     bool locked() const
     {
@@ -82,6 +99,8 @@ protected:
     virtual void processPhase(float *samples_out) const = 0;
 
 private:
+    void track(float sample_in); //!< phase error, loop filter and NCO update with the current m_psin and m_pcos
+
     float    m_minfreq, m_maxfreq;
     float    m_phasor_b0, m_phasor_a1, m_phasor_a2;
     float    m_phasor_i1, m_phasor_i2, m_phasor_q1, m_phasor_q2;
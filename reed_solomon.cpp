@@ -1,7 +1,7 @@
 ///////////////////////////////////////////////////////////////////////////////////
 // Copyright (C) 2025 Mike Cornelius, VK2XMC.                                    //       
 // Based on the work of Edouard Griffiths, F4EXB.                                //
-//                                                                               //
+//                                                                               //       
 // This program is free software; you can redistribute it and/or modify          //
 // it under the terms of the GNU General Public License as published by          //
 // the Free Software Foundation as version 3 of the License, or                  //
@@ -15,32 +15,264 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>
+#include <assert.h>
+
 #include "reed_solomon.h"
 
 namespace DSDcc
 {
 
-ReedSolomon_24_12_13::ReedSolomon_24_12_13()
+unsigned char ReedSolomonGF64::m_exp[2*63];
+unsigned char ReedSolomonGF64::m_log[64];
+
+ReedSolomonGF64::ReedSolomonGF64(int n, int k) :
+        m_n(n),
+        m_k(k),
+        m_nroots(n - k)
+{
+    static const bool initialized = (init(), true);
+    (void) initialized;
+
+    assert((n <= 63) && (k > 0) && (m_nroots > 0) && (m_nroots <= 16));
+
+    // g(x) = (x + alpha^1)(x + alpha^2)...(x + alpha^nroots)
+    memset(m_generator, 0, sizeof(m_generator));
+    m_generator[0] = 1;
+
+    for (int j = 1; j <= m_nroots; j++)
+    {
+        for (int i = j; i > 0; i--) {
+            m_generator[i] = m_generator[i-1] ^ mul(m_generator[i], m_exp[j]);
+        }
+
+        m_generator[0] = mul(m_generator[0], m_exp[j]);
+    }
+}
+
+ReedSolomonGF64::~ReedSolomonGF64()
+{
+}
+
+void ReedSolomonGF64::init()
+{
+    unsigned int x = 1;
+
+    for (int i = 0; i < 63; i++)
+    {
+        m_exp[i] = x;
+        m_exp[i+63] = x;
+        m_log[x] = i;
+        x <<= 1;
+
+        if (x & 0x40) {
+            x ^= 0x43; // x^6 + x + 1
+        }
+    }
+
+    m_log[0] = 0; // not used
+}
+
+void ReedSolomonGF64::encode(unsigned char *hexbits) const
+{
+    unsigned char *parity = &hexbits[m_k]; // division remainder, highest degree first
+    memset(parity, 0, m_nroots);
+
+    for (int i = 0; i < m_k; i++)
+    {
+        unsigned char feedback = (hexbits[i] & 0x3F) ^ parity[0];
+
+        for (int j = 0; j < m_nroots - 1; j++) {
+            parity[j] = parity[j+1] ^ mul(feedback, m_generator[m_nroots-1-j]);
+        }
+
+        parity[m_nroots-1] = mul(feedback, m_generator[0]);
+    }
+}
+
+bool ReedSolomonGF64::decode(unsigned char *hexbits) const
+{
+    int nbErrors;
+    return decode(hexbits, nbErrors);
+}
+
+bool ReedSolomonGF64::decode(unsigned char *hexbits, int& nbErrors) const
+{
+    unsigned char syndromes[16];
+    bool hasErrors = false;
+    nbErrors = 0;
+
+    // syndromes S(j) = c(alpha^j) for j = 1..nroots
+
+    for (int j = 0; j < m_nroots; j++)
+    {
+        unsigned char s = 0;
+
+        for (int i = 0; i < m_n; i++) {
+            s = mul(s, m_exp[j+1]) ^ (hexbits[i] & 0x3F);
+        }
+
+        syndromes[j] = s;
+        hasErrors |= (s != 0);
+    }
+
+    if (!hasErrors) {
+        return true;
+    }
+
+    // Berlekamp-Massey: error locator polynomial lambda by increasing degree
+
+    unsigned char lambda[17], b[17], t[17];
+    int l = 0;      // current number of errors
+    int m = 1;      // steps since last length change
+    unsigned char bDiscrepancy = 1;
+
+    memset(lambda, 0, sizeof(lambda));
+    memset(b, 0, sizeof(b));
+    lambda[0] = 1;
+    b[0] = 1;
+
+    for (int r = 0; r < m_nroots; r++)
+    {
+        unsigned char delta = syndromes[r];
+
+        for (int i = 1; i <= l; i++) {
+            delta ^= mul(lambda[i], syndromes[r-i]);
+        }
+
+        if (delta == 0)
+        {
+            m++;
+            continue;
+        }
+
+        unsigned char scale = m_exp[m_log[delta] + 63 - m_log[bDiscrepancy]]; // delta / b
+        memcpy(t, lambda, sizeof(lambda));
+
+        for (int i = 0; i + m <= m_nroots; i++) {
+            lambda[i+m] ^= mul(scale, b[i]);
+        }
+
+        if (2*l <= r)
+        {
+            l = r + 1 - l;
+            memcpy(b, t, sizeof(b));
+            bDiscrepancy = delta;
+            m = 1;
+        }
+        else
+        {
+            m++;
+        }
+    }
+
+    if (2*l > m_nroots) { // beyond correction capacity
+        return false;
+    }
+
+    // Chien search restricted to the positions of the shortened code.
+    // Hexbit i has degree n-1-i and is in error if lambda(alpha^-(n-1-i)) = 0
+
+    int positions[8];
+    int nbRoots = 0;
+
+    for (int i = 0; i < m_n; i++)
+    {
+        int inverse = (63 - (m_n - 1 - i)) % 63;
+        unsigned char v = lambda[0];
+
+        for (int d = 1; d <= l; d++)
+        {
+            if (lambda[d]) {
+                v ^= m_exp[(m_log[lambda[d]] + d*inverse) % 63];
+            }
+        }
+
+        if (v == 0)
+        {
+            if (nbRoots == l) {
+                return false;
+            }
+
+            positions[nbRoots++] = i;
+        }
+    }
+
+    if (nbRoots != l) { // some roots are outside the code or lambda does not split
+        return false;
+    }
+
+    // Forney: omega(x) = S(x).lambda(x) mod x^nroots then e = omega(X^-1) / lambda'(X^-1) for first root alpha^1
+
+    unsigned char omega[16];
+
+    for (int i = 0; i < m_nroots; i++)
+    {
+        omega[i] = 0;
+
+        for (int j = 0; j <= i && j <= l; j++) {
+            omega[i] ^= mul(syndromes[i-j], lambda[j]);
+        }
+    }
+
+    for (int e = 0; e < nbRoots; e++)
+    {
+        int inverse = (63 - (m_n - 1 - positions[e])) % 63;
+        unsigned char num = 0;
+        unsigned char den = 0;
+
+        for (int i = 0; i < m_nroots; i++)
+        {
+            if (omega[i]) {
+                num ^= m_exp[(m_log[omega[i]] + i*inverse) % 63];
+            }
+        }
+
+        for (int i = 1; i <= l; i += 2) // formal derivative keeps odd terms only
+        {
+            if (lambda[i]) {
+                den ^= m_exp[(m_log[lambda[i]] + (i-1)*inverse) % 63];
+            }
+        }
+
+        if (den == 0) {
+            return false;
+        }
+
+        if (num) {
+            hexbits[positions[e]] ^= m_exp[m_log[num] + 63 - m_log[den]];
+        }
+    }
+
+    nbErrors = nbRoots;
+    return true;
+}
+
+ReedSolomon_24_12_13::ReedSolomon_24_12_13() :
+        ReedSolomonGF64(24, 12)
 {
-    // Initialize Reed-Solomon decoder
 }
 
 ReedSolomon_24_12_13::~ReedSolomon_24_12_13()
 {
-    // Cleanup
 }
 
-bool ReedSolomon_24_12_13::decode(unsigned char* data, int blocks)
+ReedSolomon_24_16_9::ReedSolomon_24_16_9() :
+        ReedSolomonGF64(24, 16)
+{
+}
+
+ReedSolomon_24_16_9::~ReedSolomon_24_16_9()
+{
+}
+
+ReedSolomon_36_20_17::ReedSolomon_36_20_17() :
+        ReedSolomonGF64(36, 20)
+{
+}
+
+ReedSolomon_36_20_17::~ReedSolomon_36_20_17()
 {
-    // Simplified Reed-Solomon decoder
-    // This is a stub implementation that just returns success
-    // A full implementation would include:
-    // - Galois field arithmetic
-    // - Syndrome calculation
-    // - Error locator polynomial
-    // - Error correction
-    
-    return true; // Assume success for now
 }
 
-} // namespace DSDcc
\ No newline at end of file
+} // namespace DSDcc
@@ -23,19 +23,63 @@
 namespace DSDcc
 {
 
-class DSDCC_API ReedSolomon_24_12_13
+/**
+ * Reed-Solomon codes over GF(64) (primitive polynomial x^6 + x + 1) used by P25 phase 1. These are
+ * shortened RS(63,63-(n-k)) codes with generator roots alpha^1 to alpha^(n-k).
+ * Codewords are arrays of n hexbits (6 bit values one per byte) with the k data hexbits first followed
+ * by the n-k parity hexbits. The first hexbit is the highest degree coefficient.
+ * Decoding uses Berlekamp-Massey and Chien search and works on the stack only.
+ */
+class DSDCC_API ReedSolomonGF64
+{
+public:
+    ReedSolomonGF64(int n, int k);
+    ~ReedSolomonGF64();
+
+    void encode(unsigned char *hexbits) const;                //!< compute the n-k parity hexbits from the k data hexbits
+    bool decode(unsigned char *hexbits, int& nbErrors) const; //!< correct in place. Returns false if uncorrectable
+    bool decode(unsigned char *hexbits) const;
+
+    int getN() const { return m_n; }
+    int getK() const { return m_k; }
+
+private:
+    static void init();
+    static inline unsigned char mul(unsigned char a, unsigned char b)
+    {
+        return (a && b) ? m_exp[m_log[a] + m_log[b]] : 0;
+    }
+
+    static unsigned char m_exp[2*63]; //!< antilog table doubled so that sums of logs need no modulo
+    static unsigned char m_log[64];   //!< log table. log of 0 is not used
+
+    int m_n;
+    int m_k;
+    int m_nroots;
+    unsigned char m_generator[17];    //!< generator polynomial coefficients by increasing degree
+};
+
+class DSDCC_API ReedSolomon_24_12_13 : public ReedSolomonGF64
 {
 public:
     ReedSolomon_24_12_13();
     ~ReedSolomon_24_12_13();
-    
-    bool decode(unsigned char* data, int blocks);
+};
 
-private:
-    // Reed-Solomon implementation details would go here
-    // For now, this is a stub implementation
+class DSDCC_API ReedSolomon_24_16_9 : public ReedSolomonGF64
+{
+public:
+    ReedSolomon_24_16_9();
+    ~ReedSolomon_24_16_9();
+};
+
+class DSDCC_API ReedSolomon_36_20_17 : public ReedSolomonGF64
+{
+public:
+    ReedSolomon_36_20_17();
+    ~ReedSolomon_36_20_17();
 };
 
 } // namespace DSDcc
 
-#endif /* REED_SOLOMON_H_ */
\ No newline at end of file
+#endif /* REED_SOLOMON_H_ */
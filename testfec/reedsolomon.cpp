@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+#include "../reed_solomon.h"
+
+/**
+ * Round trip of random codewords with 0 to 2t hexbit errors at random positions. Up to t errors must
+ * be corrected and counted. Beyond t the decoder must either fail or return a valid codeword.
+ */
+bool testCode(const DSDcc::ReedSolomonGF64& rs, const char *name, int nbTrials)
+{
+    int n = rs.getN();
+    int k = rs.getK();
+    int t = (n - k) / 2;
+    unsigned char codeword[63], xcodeword[63], check[63];
+    bool ok = true;
+
+    std::cout << name << " t=" << t << std::endl;
+
+    for (int nbErrors = 0; nbErrors <= 2*t; nbErrors++)
+    {
+        int corrected = 0, failed = 0, miscorrected = 0, wrong = 0;
+
+        for (int trial = 0; trial < nbTrials; trial++)
+        {
+            for (int i = 0; i < k; i++) {
+                codeword[i] = rand() & 0x3F;
+            }
+
+            rs.encode(codeword);
+            memcpy(xcodeword, codeword, n);
+
+            for (int e = 0; e < nbErrors; e++)
+            {
+                int pos;
+
+                do {
+                    pos = rand() % n;
+                } while (xcodeword[pos] != codeword[pos]); // distinct positions
+
+                xcodeword[pos] ^= 1 + (rand() % 63);       // non zero error value
+            }
+
+            int nbCorrected;
+
+            if (!rs.decode(xcodeword, nbCorrected))
+            {
+                failed++;
+            }
+            else if (memcmp(xcodeword, codeword, n) == 0)
+            {
+                corrected++;
+
+                if (nbCorrected != nbErrors) {
+                    wrong++;
+                }
+            }
+            else
+            {
+                memcpy(check, xcodeword, k);
+                rs.encode(check);
+
+                if (memcmp(check, xcodeword, n) == 0) {
+                    miscorrected++; // another codeword within t of the received word
+                } else {
+                    wrong++;
+                }
+            }
+        }
+
+        bool pass = (wrong == 0) && ((nbErrors > t) || (corrected == nbTrials));
+        ok = ok && pass;
+
+        std::cout << "  " << nbErrors << " errors: corrected " << corrected
+                << " failed " << failed
+                << " miscorrected " << miscorrected
+                << (pass ? " OK" : " FAILED") << std::endl;
+    }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    DSDcc::ReedSolomon_24_12_13 rs_24_12_13;
+    DSDcc::ReedSolomon_24_16_9 rs_24_16_9;
+    DSDcc::ReedSolomon_36_20_17 rs_36_20_17;
+    bool ok = true;
+
+    srand(1);
+    ok = testCode(rs_24_12_13, "RS(24,12,13)", 2000) && ok;
+    ok = testCode(rs_24_16_9, "RS(24,16,9)", 2000) && ok;
+    ok = testCode(rs_36_20_17, "RS(36,20,17)", 2000) && ok;
+
+    std::cout << (ok ? "Decoding OK" : "Decoding error") << std::endl;
+    return ok ? 0 : 1;
+}
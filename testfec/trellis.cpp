@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+#include "../fec.h"
+
+/**
+ * Round trip of random blocks of 48 symbols through the P25 trellis encoder and Viterbi decoder with
+ * adjacent C4FM level errors on random dibits. This is the most likely symbol error with noise.
+ */
+static void adjacentLevelError(unsigned char& dibit)
+{
+    static const int levels[4] = {2, 3, 1, 0};     // level by dibit (+1, +3, -1, -3)
+    static const unsigned char dibits[4] = {3, 2, 0, 1}; // dibit by level
+    int level = levels[dibit];
+
+    if (level == 0) {
+        level = 1;
+    } else if (level == 3) {
+        level = 2;
+    } else {
+        level += (rand() & 1) ? 1 : -1;
+    }
+
+    dibit = dibits[level];
+}
+
+bool testTrellis(const DSDcc::P25Trellis& trellis, int symbolBits, const char *name, int nbTrials)
+{
+    unsigned char symbols[48], decodedSymbols[48], dibits[98];
+    bool ok = true;
+
+    std::cout << name << std::endl;
+
+    for (int nbErrors = 0; nbErrors <= 4; nbErrors++)
+    {
+        int correct = 0, distanceErrors = 0;
+
+        for (int trial = 0; trial < nbTrials; trial++)
+        {
+            for (int i = 0; i < 48; i++) {
+                symbols[i] = rand() & ((1 << symbolBits) - 1);
+            }
+
+            trellis.encode(symbols, dibits);
+            bool corrupted[98];
+            memset(corrupted, 0, sizeof(corrupted));
+
+            for (int e = 0; e < nbErrors; e++)
+            {
+                int pos;
+
+                do {
+                    pos = rand() % 98;
+                } while (corrupted[pos]);
+
+                corrupted[pos] = true;
+                adjacentLevelError(dibits[pos]);
+            }
+
+            int distance = trellis.decode(dibits, decodedSymbols);
+
+            if (memcmp(symbols, decodedSymbols, 48) == 0)
+            {
+                correct++;
+
+                if (distance != nbErrors) { // one level per error on the right path
+                    distanceErrors++;
+                }
+            }
+        }
+
+        // single errors must always be corrected
+        bool pass = (distanceErrors == 0) && ((nbErrors > 1) || (correct == nbTrials));
+        ok = ok && pass;
+
+        std::cout << "  " << nbErrors << " errors: decoded " << correct << " / " << nbTrials
+                << (pass ? " OK" : " FAILED") << std::endl;
+    }
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    DSDcc::P25Trellis_1_2 trellis_1_2;
+    DSDcc::P25Trellis_3_4 trellis_3_4;
+    bool ok = true;
+
+    srand(1);
+    ok = testTrellis(trellis_1_2, 2, "P25 1/2 rate trellis", 20000) && ok;
+    ok = testTrellis(trellis_3_4, 3, "P25 3/4 rate trellis", 20000) && ok;
+
+    std::cout << (ok ? "Decoding OK" : "Decoding error") << std::endl;
+    return ok ? 0 : 1;
+}
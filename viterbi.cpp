@@ -18,7 +18,9 @@
 #include <iostream>
 #include <string.h>
 #include <limits.h>
+#include <assert.h>
 #include "viterbi.h"
+#include "dsd_simd.h"
 
 namespace DSDcc
 {
@@ -109,8 +111,185 @@ const unsigned char Viterbi::NbOnes[] = {
 		5, 6, 6, 7, 6, 7, 7, 8,
 };
 
-const uint32_t Viterbi::m_maxMetric = 0xFFFE0000; // Account for any possible accumulation of branch metrics
+// Path metrics are 16 bit integers kept modulo 2^16. Two metrics are compared through the sign
+// of their difference so the ACS never needs renormalization as long as the spread of metrics
+// across states stays below 2^15 which is the case for the small constraint lengths used here.
 
+// All kernels run the ACS over a whole sequence. Branch metrics for step i are the 4 rows found at
+// bmTable + 4*half*symbols[i] or at bmTable + 4*half*i if symbols is null. metrics holds two sets of
+// 64 path metrics, the first one is the initial set on input and the final set on output.
+
+template<int Half, bool TieOnBranch>
+static void acsScalarRun(int half, const int16_t *bmTable, const unsigned char *symbols, unsigned int symbolMask,
+        unsigned int nbSymbols, int16_t *metrics, uint64_t *decisions)
+{
+    int16_t *pm = metrics;
+    int16_t *npm = &metrics[64];
+
+    if (Half != 0) { // number of states known at compile time
+        half = Half;
+    }
+
+    for (unsigned int is = 0; is < nbSymbols; is++)
+    {
+        const int16_t *bm = &bmTable[4*half*(symbols ? (symbols[is] & symbolMask) : is)];
+        uint64_t d = 0;
+
+        for (int s = 0; s < half; s++)
+        {
+            for (int bit = 0; bit < 2; bit++)
+            {
+                int16_t bmA = bm[(2*bit)*half + s];
+                int16_t bmB = bm[(2*bit+1)*half + s];
+                int16_t mA = (int16_t) (pm[2*s] + bmA);   // upper path
+                int16_t mB = (int16_t) (pm[2*s+1] + bmB); // lower path
+                int16_t diff = (int16_t) (mA - mB);
+                bool lower = TieOnBranch ? (diff > 0) || ((diff == 0) && (bmA > bmB)) : (diff >= 0);
+                npm[s + bit*half] = lower ? mB : mA;
+                d |= (uint64_t) lower << (s + bit*half);
+            }
+        }
+
+        decisions[is] = d;
+        int16_t *tmp = pm;
+        pm = npm;
+        npm = tmp;
+    }
+
+    if (pm != metrics) {
+        memcpy(metrics, pm, 2*half*sizeof(int16_t));
+    }
+}
+
+template<int Half>
+static void acsScalar(int half, const int16_t *bmTable, const unsigned char *symbols, unsigned int symbolMask,
+        unsigned int nbSymbols, int16_t *metrics, uint64_t *decisions, bool tieOnBranch)
+{
+    if (tieOnBranch) {
+        acsScalarRun<Half, true>(half, bmTable, symbols, symbolMask, nbSymbols, metrics, decisions);
+    } else {
+        acsScalarRun<Half, false>(half, bmTable, symbols, symbolMask, nbSymbols, metrics, decisions);
+    }
+}
+
+#ifdef DSD_SIMD_X86
+
+DSD_SIMD_TARGET("sse2")
+static void acsSSE2(int half, const int16_t *bmTable, const unsigned char *symbols, unsigned int symbolMask,
+        unsigned int nbSymbols, int16_t *metrics, uint64_t *decisions, bool tieOnBranch)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_cmpeq_epi16(zero, zero);
+    int16_t *pm = metrics;
+    int16_t *npm = &metrics[64];
+
+    for (unsigned int is = 0; is < nbSymbols; is++)
+    {
+        const int16_t *bm = &bmTable[4*half*(symbols ? (symbols[is] & symbolMask) : is)];
+        uint64_t d = 0;
+
+        for (int s = 0; s < half; s += 8)
+        {
+            // split previous metrics into upper (even) and lower (odd) predecessors
+            __m128i p0 = _mm_loadu_si128((const __m128i*) &pm[2*s]);
+            __m128i p1 = _mm_loadu_si128((const __m128i*) &pm[2*s + 8]);
+            __m128i pmA = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(p0, 16), 16), _mm_srai_epi32(_mm_slli_epi32(p1, 16), 16));
+            __m128i pmB = _mm_packs_epi32(_mm_srai_epi32(p0, 16), _mm_srai_epi32(p1, 16));
+
+            for (int bit = 0; bit < 2; bit++)
+            {
+                __m128i bmA = _mm_loadu_si128((const __m128i*) &bm[(2*bit)*half + s]);
+                __m128i bmB = _mm_loadu_si128((const __m128i*) &bm[(2*bit+1)*half + s]);
+                __m128i mA = _mm_add_epi16(pmA, bmA);
+                __m128i mB = _mm_add_epi16(pmB, bmB);
+                __m128i diff = _mm_sub_epi16(mA, mB);
+                __m128i lower = _mm_or_si128(_mm_cmpgt_epi16(diff, zero),
+                        _mm_and_si128(_mm_cmpeq_epi16(diff, zero), tieOnBranch ? _mm_cmpgt_epi16(bmA, bmB) : ones));
+                _mm_storeu_si128((__m128i*) &npm[s + bit*half], _mm_or_si128(_mm_and_si128(lower, mB), _mm_andnot_si128(lower, mA)));
+                d |= (uint64_t) _mm_movemask_epi8(_mm_packs_epi16(lower, zero)) << (s + bit*half);
+            }
+        }
+
+        decisions[is] = d;
+        int16_t *tmp = pm;
+        pm = npm;
+        npm = tmp;
+    }
+
+    if (pm != metrics) {
+        memcpy(metrics, pm, 2*half*sizeof(int16_t));
+    }
+}
+
+DSD_SIMD_TARGET("avx2")
+static void acsAVX2(int half, const int16_t *bmTable, const unsigned char *symbols, unsigned int symbolMask,
+        unsigned int nbSymbols, int16_t *metrics, uint64_t *decisions, bool tieOnBranch)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_cmpeq_epi16(zero, zero);
+    int16_t *pm = metrics;
+    int16_t *npm = &metrics[64];
+
+    for (unsigned int is = 0; is < nbSymbols; is++)
+    {
+        const int16_t *bm = &bmTable[4*half*(symbols ? (symbols[is] & symbolMask) : is)];
+        uint64_t d = 0;
+
+        for (int s = 0; s < half; s += 16)
+        {
+            // split previous metrics into upper (even) and lower (odd) predecessors. Packing works on
+            // 128 bit lanes so 64 bit quarters have to be put back in order
+            __m256i p0 = _mm256_loadu_si256((const __m256i*) &pm[2*s]);
+            __m256i p1 = _mm256_loadu_si256((const __m256i*) &pm[2*s + 16]);
+            __m256i pmA = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+                    _mm256_srai_epi32(_mm256_slli_epi32(p0, 16), 16), _mm256_srai_epi32(_mm256_slli_epi32(p1, 16), 16)), 0xD8);
+            __m256i pmB = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_srai_epi32(p0, 16), _mm256_srai_epi32(p1, 16)), 0xD8);
+
+            for (int bit = 0; bit < 2; bit++)
+            {
+                __m256i bmA = _mm256_loadu_si256((const __m256i*) &bm[(2*bit)*half + s]);
+                __m256i bmB = _mm256_loadu_si256((const __m256i*) &bm[(2*bit+1)*half + s]);
+                __m256i mA = _mm256_add_epi16(pmA, bmA);
+                __m256i mB = _mm256_add_epi16(pmB, bmB);
+                __m256i diff = _mm256_sub_epi16(mA, mB);
+                __m256i lower = _mm256_or_si256(_mm256_cmpgt_epi16(diff, zero),
+                        _mm256_and_si256(_mm256_cmpeq_epi16(diff, zero), tieOnBranch ? _mm256_cmpgt_epi16(bmA, bmB) : ones));
+                _mm256_storeu_si256((__m256i*) &npm[s + bit*half], _mm256_blendv_epi8(mA, mB, lower));
+                __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(lower, lower), 0xD8);
+                d |= (uint64_t) (_mm256_movemask_epi8(packed) & 0xFFFF) << (s + bit*half);
+            }
+        }
+
+        decisions[is] = d;
+        int16_t *tmp = pm;
+        pm = npm;
+        npm = tmp;
+    }
+
+    if (pm != metrics) {
+        memcpy(metrics, pm, 2*half*sizeof(int16_t));
+    }
+}
+
+#endif // DSD_SIMD_X86
+
+Viterbi::ACSKernel Viterbi::selectKernel(int half)
+{
+#ifdef DSD_SIMD_X86
+    if ((half % 16 == 0) && DSDSimd::hasAVX2()) {
+        return acsAVX2;
+    }
+
+    if ((half % 8 == 0) && DSDSimd::hasSSE2()) {
+        return acsSSE2;
+    }
+#endif
+    if (half == 2) {
+        return acsScalar<2>;
+    }
+
+    return acsScalar<0>;
+}
 
 Viterbi::Viterbi(int k, int n, const unsigned int *polys, bool msbFirst) :
         m_k(k),
@@ -118,17 +297,22 @@ Viterbi::Viterbi(int k, int n, const unsigned int *polys, bool msbFirst) :
         m_polys(polys),
         m_msbFirst(msbFirst),
         m_nbSymbolsMax(0),
-        m_nbBitsMax(0)
+        m_nbBitsMax(0),
+        m_nbSoftSymbolsMax(0)
 {
+    assert(k <= 7);
     m_branchCodes = new unsigned char[(1<<m_k)];
     m_predA = new unsigned char[1<<(m_k-1)];
     m_predB = new unsigned char[1<<(m_k-1)];
-    m_pathMetrics = 0;
-    m_traceback = 0;
+    m_branchMetrics = new int16_t[(1<<m_n) * 2 * (1<<(m_k-1))];
+    m_softBranchMetrics = 0;
+    m_decisions = 0;
     m_symbols = 0;
+    m_acsKernel = selectKernel((1<<(m_k-1))/2);
 
     initCodes();
     initTreillis();
+    initBranchMetrics();
 }
 
 Viterbi::~Viterbi()
@@ -137,14 +321,15 @@ Viterbi::~Viterbi()
         delete[] m_symbols;
     }
 
-    if (m_pathMetrics) {
-        delete[] m_pathMetrics;
+    if (m_decisions) {
+        delete[] m_decisions;
     }
 
-    if (m_traceback) {
-        delete[] m_traceback;
+    if (m_softBranchMetrics) {
+        delete[] m_softBranchMetrics;
     }
 
+    delete[] m_branchMetrics;
     delete[] m_predB;
     delete[] m_predA;
 	delete[] m_branchCodes;
@@ -177,6 +362,24 @@ void Viterbi::initTreillis()
     }
 }
 
+void Viterbi::initBranchMetrics()
+{
+    int half = (1<<(m_k-1))/2;
+
+    for (int symbol = 0; symbol < (1<<m_n); symbol++)
+    {
+        int16_t *bm = &m_branchMetrics[4*half*symbol];
+
+        for (int s = 0; s < half; s++)
+        {
+            bm[0*half + s] = NbOnes[m_branchCodes[((2*s)<<1)]     ^ symbol]; // upper path to bit 0
+            bm[1*half + s] = NbOnes[m_branchCodes[((2*s+1)<<1)]   ^ symbol]; // lower path to bit 0
+            bm[2*half + s] = NbOnes[m_branchCodes[((2*s)<<1)+1]   ^ symbol]; // upper path to bit 1
+            bm[3*half + s] = NbOnes[m_branchCodes[((2*s+1)<<1)+1] ^ symbol]; // lower path to bit 1
+        }
+    }
+}
+
 void Viterbi::encodeToSymbols(
         unsigned char *symbols,
         const unsigned char *dataBits,
@@ -255,144 +458,125 @@ void Viterbi::decodeFromSymbols(
         unsigned int nbSymbols,       //!< Number of input symbols
         unsigned int startstate)      //!< Encoder starting state
 
+{
+    (void) startstate; // all states start even
+    decodeACS(dataBits, m_branchMetrics, symbols, nbSymbols, TieBranchMetric, false);
+}
+
+void Viterbi::decodeFromSoftSymbols(
+        unsigned char *dataBits,       //!< Decoded output data bits
+        const unsigned char *softBits, //!< Input soft bits (m_n per symbol)
+        unsigned int nbSymbols,        //!< Number of input symbols
+        unsigned int startstate)       //!< Encoder starting state
+
+{
+    (void) startstate; // all states start even
+    decodeSoftACS(dataBits, softBits, nbSymbols, TieBranchMetric, false);
+}
+
+void Viterbi::allocateDecisions(unsigned int nbSymbols)
 {
     if (nbSymbols > m_nbSymbolsMax)
     {
-        if (m_traceback) {
-            delete[] m_traceback;
-        }
-
-        if (m_pathMetrics) {
-            delete[] m_pathMetrics;
+        if (m_decisions) {
+            delete[] m_decisions;
         }
 
-        m_traceback = new unsigned char[(1<<(m_k-1)) * nbSymbols];
-        m_pathMetrics = new uint32_t[(1<<(m_k-1))*2]; // only one step back in memory
+        m_decisions = new uint64_t[nbSymbols];
         m_nbSymbolsMax = nbSymbols;
     }
+}
 
-    // initial path metrics state
-    memset(m_pathMetrics, m_maxMetric, sizeof(uint32_t) * (1<<(m_k-1)));
-    m_pathMetrics[startstate] = 0;
+void Viterbi::decodeACS(
+        unsigned char *dataBits,
+        const int16_t *bmTable,
+        const unsigned char *symbols,
+        unsigned int nbSymbols,
+        TieBreak tieBreak,
+        bool fromBestState)
+{
+    int half = (1<<(m_k-1))/2;
 
-    unsigned int minPathIndex;
-    unsigned int minMetric;
+    allocateDecisions(nbSymbols);
+    memset(m_acsMetrics, 0, (1<<(m_k-1)) * sizeof(int16_t));
+    m_acsKernel(half, bmTable, symbols, (1<<m_n) - 1, nbSymbols, m_acsMetrics, m_decisions, tieBreak == TieBranchMetric);
+    traceBack(dataBits, nbSymbols, m_acsMetrics, fromBestState);
+}
+
+/**
+ * The branch metric of a code bit is its soft value if the bit is 0 and 15 minus its soft value if it is 1.
+ * With hard input bits (0 or 15) metrics are 15 times the Hamming distances and the result is the same
+ * as hard decoding. Rows for each step are laid out as for a hard symbol value in initBranchMetrics.
+ */
+void Viterbi::decodeSoftACS(
+        unsigned char *dataBits,
+        const unsigned char *softBits,
+        unsigned int nbSymbols,
+        TieBreak tieBreak,
+        bool fromBestState)
+{
+    int half = (1<<(m_k-1))/2;
+    assert(m_n <= 4);
+
+    if (nbSymbols > m_nbSoftSymbolsMax)
+    {
+        if (m_softBranchMetrics) {
+            delete[] m_softBranchMetrics;
+        }
+
+        m_softBranchMetrics = new int16_t[4*half*nbSymbols];
+        m_nbSoftSymbolsMax = nbSymbols;
+    }
 
     for (unsigned int is = 0; is < nbSymbols; is++)
     {
-        minMetric = m_maxMetric;
-//        std::cerr << "S[" << is << "]=" << (int) symbols[is] << std::endl;
-
-        // compute branch metrics
-    	for (int ib = 0; ib < 1<<(m_k-1); ib++)
-    	{
-            unsigned char bit = ib < 1<<(m_k-2) ? 0 : 1;
-
-            // path A
-
-    	    unsigned char predA = m_predA[ib];
-    	    unsigned int predPMIxA = (is%2)*(1<<(m_k-1)) + predA;
-    	    unsigned char codeA = m_branchCodes[(predA<<1)+bit];
-    	    unsigned char bmA = NbOnes[codeA ^ symbols[is]]; // branch metric
-    	    unsigned int pmA = m_pathMetrics[predPMIxA] + bmA; // add branch metric to path metric
-
-            // path B
-
-    	    unsigned char predB = m_predB[ib];
-            unsigned int predPMIxB = (is%2)*(1<<(m_k-1)) + predB;
-            unsigned char codeB = m_branchCodes[(predB<<1)+bit];
-            unsigned char bmB = NbOnes[codeB ^ symbols[is]]; // branch metric
-            unsigned int pmB = m_pathMetrics[predPMIxB] + bmB; // add branch metric to path metric
-
-            // decisions, decisions ...
-
-//            std::cerr << "  Branch:"
-//                    << " " << ib
-//                    << " bit: " << (int) bit
-//                    << " predA: " << (int) predA
-//                    << " pm[" << (int) predA << ":" << is*(1<<(m_k-1)) << "]: " << m_pathMetrics[predPMIxA]
-//                    << " codeA: " << (int) codeA
-//                    << " bmA: " << (int) bmA
-//                    << " pmA: " << pmA
-//                    << " | predB: " << (int) predB
-//                    << " pm[" << (int) predB << ":" << is*(1<<(m_k-1)) << "]: " << m_pathMetrics[predPMIxB]
-//                    << " codeB: " << (int) codeB
-//                    << " bmB: " << (int) bmB
-//                    << " pmB: " << pmB << std::endl;
-
-            bool a_b; // true: A, false: B
-
-            if (pmA == pmB) // path metrics are even
-            {
-                if (bmA == bmB)
-                {
-                    a_b = true; // arbitrary
-                }
-                else
-                {
-                    a_b = bmA < bmB;
-                }
-            }
-            else
-            {
-                a_b = pmA < pmB;
-            }
+        const unsigned char *soft = &softBits[m_n*is];
+        int16_t *bm = &m_softBranchMetrics[4*half*is];
+        int16_t codeMetrics[16]; // metric for each possible code symbol
 
-            if (a_b) // A selected
-            {
-                m_pathMetrics[ib + ((is+1)%2)*(1<<(m_k-1))] = pmA;
-                m_traceback[ib + is*(1<<(m_k-1))] = predA; // Pack predecessor branch # and bit value
-
-                if (pmA < minMetric)
-                {
-                    minMetric = pmA;
-                    minPathIndex = ib;
-                }
-
-//                std::cerr << "    Select A:"
-//                        << " pm: " << pmA
-//                        << " bit: " << (int) bit
-//                        << " m_traceback[" << ib + is*(1<<(m_k-1)) << "]: " << (int) predA
-//                        << std::endl;
-            }
-            else
-            {
-                m_pathMetrics[ib + ((is+1)%2)*(1<<(m_k-1))] = pmB;
-                m_traceback[ib + is*(1<<(m_k-1))] = predB; // Pack predecessor branch # and bit value
+        for (int code = 0; code < (1<<m_n); code++)
+        {
+            codeMetrics[code] = 0;
 
-                if (pmB < minMetric)
-                {
-                    minMetric = pmB;
-                    minPathIndex = ib;
-                }
+            for (int j = 0; j < m_n; j++) {
+                codeMetrics[code] += ((code>>j) & 1) ? 15 - (soft[j] & 15) : (soft[j] & 15);
+            }
+        }
 
-//                std::cerr << "    Select B:"
-//                        << " pm: " << pmB
-//                        << " bit: " << (int) bit
-//                        << " m_traceback[" << ib + is*(1<<(m_k-1)) << "]: " << (int) predB
-//                        << std::endl;
+        for (int s = 0; s < half; s++)
+        {
+            bm[0*half + s] = codeMetrics[m_branchCodes[((2*s)<<1)]];     // upper path to bit 0
+            bm[1*half + s] = codeMetrics[m_branchCodes[((2*s+1)<<1)]];   // lower path to bit 0
+            bm[2*half + s] = codeMetrics[m_branchCodes[((2*s)<<1)+1]];   // upper path to bit 1
+            bm[3*half + s] = codeMetrics[m_branchCodes[((2*s+1)<<1)+1]]; // lower path to bit 1
+        }
+    }
 
-            } // path decision
-    	} // branches
-    } // symbols
+    decodeACS(dataBits, m_softBranchMetrics, 0, nbSymbols, tieBreak, fromBestState);
+}
 
-    // trace back
+void Viterbi::traceBack(unsigned char *dataBits, unsigned int nbSymbols, const int16_t *pathMetrics, bool fromBestState)
+{
+    unsigned int half = (1<<(m_k-1))/2;
+    unsigned int state = 0;
 
-    int bIx = minPathIndex = 0;
+    if (fromBestState)
+    {
+        for (unsigned int i = 1; i < 2*half; i++)
+        {
+            if ((int16_t) (pathMetrics[i] - pathMetrics[state]) < 0) {
+                state = i;
+            }
+        }
+    }
 
     for (int is = nbSymbols-1; is >= 0; is--)
     {
-//    	std::cerr << "is: " << is
-//    			<< " bIx: " << (int) bIx
-//    			<< " bit: " << bIx < 1<<(m_k-2) ? 0 : 1;
-//				<< " pred: " << (int) m_traceback[bIx + is*(1<<(m_k-1))]
-//				<< std::endl;
-        dataBits[is] = bIx < 1<<(m_k-2) ? 0U : 1U;
-        bIx = m_traceback[bIx + is*(1<<(m_k-1))];
+        dataBits[is] = state < half ? 0U : 1U;
+        state = 2*(state & (half-1)) + ((m_decisions[is] >> state) & 1);
     }
 }
 
-
 } // namespace DSDcc
 
 
@@ -64,6 +64,15 @@ public:
         unsigned int startstate     //!< Encoder starting state
     );
 
+    /** Soft decision Viterbi decoder. Soft bits go from 0 (certain 0) to 15 (certain 1) and come
+     *  in the same order as the bits of decodeFromBits i.e. m_n soft bits for each symbol */
+    virtual void decodeFromSoftSymbols(
+        unsigned char *dataBits,       //!< Decoded output data bits
+        const unsigned char *softBits, //!< Input soft bits (m_n per symbol)
+        unsigned int nbSymbols,        //!< Number of input symbols
+        unsigned int startstate        //!< Encoder starting state
+    );
+
     int getK() const { return m_k; }
     int getN() const { return m_n; }
     const unsigned char *getBranchCodes() const { return m_branchCodes; }
@@ -80,8 +89,47 @@ public:
     static const unsigned char NbOnes[];
 
 protected:
+    /** Selection rule when both paths into a state have the same metric */
+    typedef enum
+    {
+        TieBranchMetric, //!< keep the path with the lowest branch metric, upper path if still even
+        TieLowerPath     //!< keep the lower path (odd predecessor)
+    } TieBreak;
+
+    /** Add-compare-select over a sequence of symbols. See viterbi.cpp for the branch metrics layout.
+     *  decisions gets one bit per state and per symbol set when the lower (odd) predecessor is selected */
+    typedef void (*ACSKernel)(
+        int half,                   //!< half the number of states
+        const int16_t *bmTable,     //!< branch metrics
+        const unsigned char *symbols, //!< index of branch metrics for each step or null to use the step index
+        unsigned int symbolMask,    //!< mask applied to symbols
+        unsigned int nbSymbols,     //!< number of steps
+        int16_t *metrics,           //!< initial then final path metrics followed by a work area (2 x 64 values)
+        uint64_t *decisions,        //!< decisions output
+        bool tieOnBranch            //!< tie breaking rule is TieBranchMetric
+    );
+
     void initCodes();
     void initTreillis();
+    void initBranchMetrics();
+    void decodeACS(
+        unsigned char *dataBits,
+        const int16_t *bmTable,
+        const unsigned char *symbols,
+        unsigned int nbSymbols,
+        TieBreak tieBreak,
+        bool fromBestState
+    );
+    void decodeSoftACS(
+        unsigned char *dataBits,
+        const unsigned char *softBits,
+        unsigned int nbSymbols,
+        TieBreak tieBreak,
+        bool fromBestState
+    );
+    void allocateDecisions(unsigned int nbSymbols);
+    void traceBack(unsigned char *dataBits, unsigned int nbSymbols, const int16_t *pathMetrics, bool fromBestState);
+    static ACSKernel selectKernel(int half);
 
     static inline int parity(int x)
     {
@@ -94,15 +142,18 @@ protected:
     int m_n;
     const unsigned int *m_polys;
     bool m_msbFirst;
-    uint32_t *m_pathMetrics;
-    unsigned char *m_traceback;
     unsigned char *m_branchCodes;
     unsigned char *m_predA;
     unsigned char *m_predB;
     unsigned char *m_symbols;
     unsigned int m_nbSymbolsMax;
     unsigned int m_nbBitsMax;
-    static const uint32_t m_maxMetric;
+    unsigned int m_nbSoftSymbolsMax;
+    int16_t *m_branchMetrics;  //!< branch metrics rows for each hard symbol value
+    int16_t *m_softBranchMetrics; //!< branch metrics rows for each soft symbol
+    uint64_t *m_decisions;     //!< ACS decisions one word per symbol
+    int16_t m_acsMetrics[2*64]; //!< current and next path metrics (modulo 2^16)
+    ACSKernel m_acsKernel;
 };
 
 } // namespace DSDcc
@@ -39,6 +39,14 @@ public:
             unsigned int startstate       //!< Encoder starting state
     );
 
+    /* Viterbi decoder */
+    virtual void decodeFromSoftSymbols(
+            unsigned char *dataBits,       //!< Decoded output data bits
+            const unsigned char *softBits, //!< Input soft bits (m_n per symbol)
+            unsigned int nbSymbols,        //!< Number of input symbols
+            unsigned int startstate        //!< Encoder starting state
+    );
+
     /* Viterbi decoder */
     virtual void decodeFromBits(
         unsigned char *dataBits,    //!< Decoded output data bits
@@ -46,28 +54,6 @@ public:
         unsigned int nbBits,        //!< Number of input bits
         unsigned int startstate     //!< Encoder starting state
     );
-
-private:
-    static void doMetrics (
-            int n,
-            unsigned char *branchCodes,
-            unsigned char symbol,
-            unsigned char *m_pathMemory0,
-            unsigned char *m_pathMemory1,
-            unsigned char *m_pathMemory2,
-            unsigned char *m_pathMemory3,
-            uint32_t *m_pathMetric
-    );
-
-    static void traceBack (
-            int nbSymbols,
-            unsigned int startState,
-            unsigned char *out,
-            unsigned char *m_pathMemory0,
-            unsigned char *m_pathMemory1,
-            unsigned char *m_pathMemory2,
-            unsigned char *m_pathMemory3
-    );
 };
 
 } // namespace DSDcc
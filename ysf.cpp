@@ -194,6 +194,7 @@ DSDYSF::DSDYSF(DSDDecoder *dsdDecoder) :
         m_pn(0x1c9)
 {
     memset(m_fichRaw, 0, 100);
+    memset(m_fichSoft, 0, 2*100);
     memset(m_fichGolay, 0, 100);
     memset(m_fichBits, 0, 48);
     memset(m_dch1Raw, 0, 180);
@@ -311,11 +312,14 @@ void DSDYSF::process() // just pass the frames for now
 
 void DSDYSF::processFICH(int symbolIndex, unsigned char dibit)
 {
+    int softDibit = m_dsdDecoder->m_dsdSymbol.getSoftDibit();
     m_fichRaw[m_fichInterleave[symbolIndex]] = dibit;
+    m_fichSoft[2*m_fichInterleave[symbolIndex]]   = softDibit & 0x0F;
+    m_fichSoft[2*m_fichInterleave[symbolIndex]+1] = (softDibit >> 4) & 0x0F;
 
     if (symbolIndex == 100-1)
     {
-        m_viterbiFICH.decodeFromSymbols(m_fichGolay, m_fichRaw, 100, 0);
+        m_viterbiFICH.decodeFromSoftSymbols(m_fichGolay, m_fichSoft, 100, 0);
         int i = 0;
 
         for (; i < 4; i++)
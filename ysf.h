@@ -228,6 +228,7 @@ private:
     int m_symbolIndex;                //!< Current symbol index
 
     unsigned char m_fichRaw[100];     //!< FICH dibits after de-interleave + Viterbi stuff symbols
+    unsigned char m_fichSoft[2*100];  //!< FICH soft bits (LSB then MSB of each dibit) after de-interleave
     unsigned char m_fichGolay[100];   //!< FICH Golay encoded bits + 4 stuff bits + Viterbi stuff bits
     unsigned char m_fichBits[48];     //!< Final FICH + CRC16
     FICH          m_fich;             //!< Validated FICH